@@ -0,0 +1,23 @@
+#ifndef CONFIG_H_
+#define CONFIG_H_
+
+/* ----- Compilation options ----- */
+/* Compile the solution for these days (0 will compile all) */
+static const unsigned int COMPILE_SOLUTIONS[] = {0};
+#define BUILD_SOLUTIONS   1    /* Compile the solutions for each day */
+#define BUILD_UTILS_TESTS 0    /* Compile the tests for the utilities */
+#define BUILD_ASYNC 1          /* Compile programs concurrently */
+
+/* ----- Run options ----- */
+#define RUN_PROGS 0            /* Run all the programs that were compiled */
+#define ENABLE_PERF 0          /* Enable perf when running the programs (requires RUN_PROGS) */
+/* Which events to monitor (if perf is enabled) */
+#define PERF_EVENTS "cycles,instructions,cache-references,cache-misses,branches,branch-misses"
+
+/* ----- Other configs ----- */
+#define SILENT_BUILD_DIRS 1    /* Do not log creation of existing directories */
+#define GEN_COMPILE_COMMANDS 1 /* Generate compile_commands.json */
+
+/* ----- General constants ----- */
+#define MAX_FILE_PATH     4096 /* Maximum number of characters in a file path */
+#endif // CONFIG_H_
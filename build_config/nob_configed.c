@@ -42,15 +42,48 @@ static char base_path[MAX_FILE_PATH];
 static void get_base_path();
 static int create_output_dirs();
 static void include_utils_tests(void);
+static void include_utils_bench(void);
 static void include_solutions(void);
 static int build_from_src(void);
+static int build_all_days(Nob_Procs *procs);
 static void include_info_only(void);
 static int gen_compile_commands(void *compile_commands);
 static int run_programs(void);
+static int startup_report(void);
+static int bench_report(void);
+static int generate_inputs(int scale_count, char **scales);
+static void append_build_flags(Nob_Cmd *cmd, size_t first_flag);
+static int record_results(const char *results_path);
+static int compare_results(const char *baseline_path, const char *current_path);
+
+/* Older config.h files (see nob.c) do not have it */
+#ifndef BUILD_UTILS_BENCH
+#define BUILD_UTILS_BENCH 0
+#endif
+
+/* Days with a generator in tools/gen_input.c */
+#define GEN_INPUT_DAYS 6
+
+/* Runs of each program when measuring the startup latency */
+#ifndef STARTUP_RUNS
+#define STARTUP_RUNS "50"
+#endif
+
+/* Benchmark results of every day (see runner_record_results in utils/runner.h) */
+#define RESULTS_BASELINE BUILD_FOLDER"results/baseline.jsonl"
+#define RESULTS_CURRENT  BUILD_FOLDER"results/current.jsonl"
+
+/* Slowdown of the median below which a significant difference is not reported as a regression */
+#ifndef COMPARE_MIN_CHANGE
+#define COMPARE_MIN_CHANGE 0.02
+#endif
+
+/* One-sided Mann-Whitney z above which the difference is significant (p < 0.01) */
+#define COMPARE_Z_THRESHOLD 2.326
 
 thrd_t compile_cmds_thread;
 
-int main(void)
+int main(int argc, char **argv)
 {
     int result = 0;
 
@@ -58,10 +91,45 @@ int main(void)
 
     if (create_output_dirs() != 0) return 1;
 
+    /* ./nob startup: only build and compare the startup profiles of the days */
+    if (argc > 1 && strcmp(argv[1], "startup") == 0) {
+        return startup_report();
+    }
+
+    /* ./nob gen [scale...]: generate the inputs of every day at each scale (default 1, 10 and 100) */
+    if (argc > 1 && strcmp(argv[1], "gen") == 0) {
+        if (argc > 2) return generate_inputs(argc - 2, argv + 2);
+        char *default_scales[] = { "1", "10", "100" };
+        return generate_inputs(3, default_scales);
+    }
+
+    /* ./nob bench: only build and run the microbenchmarks of the utilities */
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        return bench_report();
+    }
+
+    /*
+     * ./nob baseline: benchmark every day and keep the results as the baseline
+     * ./nob compare: benchmark every day again and compare against the baseline
+     * ./nob compare <baseline> <current>: only compare two result files
+     */
+    if (argc > 1 && strcmp(argv[1], "baseline") == 0) {
+        return record_results(RESULTS_BASELINE);
+    }
+    if (argc > 1 && strcmp(argv[1], "compare") == 0) {
+        if (argc > 3) return compare_results(argv[2], argv[3]);
+        if (record_results(RESULTS_CURRENT) != 0) return 1;
+        return compare_results(RESULTS_BASELINE, RESULTS_CURRENT);
+    }
+
     if (BUILD_UTILS_TESTS) {
         include_utils_tests();
     }
 
+    if (BUILD_UTILS_BENCH) {
+        include_utils_bench();
+    }
+
     if (BUILD_SOLUTIONS) {
         include_solutions();
     }
@@ -125,8 +193,15 @@ static int create_output_dirs() {
 
     if (!nob_mkdir_if_not_exists(BUILD_FOLDER"solutions")) return 1;
     if (!nob_mkdir_if_not_exists(BUILD_FOLDER"solutions/template")) return 1;
+    if (!nob_mkdir_if_not_exists(BUILD_FOLDER"solutions/all")) return 1;
     if (!nob_mkdir_if_not_exists(BUILD_FOLDER"utils")) return 1;
     if (!nob_mkdir_if_not_exists(BUILD_FOLDER"utils/tests")) return 1;
+    if (!nob_mkdir_if_not_exists(BUILD_FOLDER"utils/bench")) return 1;
+    if (!nob_mkdir_if_not_exists(BUILD_FOLDER"tuning")) return 1;
+    if (!nob_mkdir_if_not_exists(BUILD_FOLDER"tools")) return 1;
+    if (!nob_mkdir_if_not_exists(BUILD_FOLDER"startup")) return 1;
+    if (!nob_mkdir_if_not_exists(BUILD_FOLDER"results")) return 1;
+    if (!nob_mkdir_if_not_exists(BUILD_FOLDER"inputs")) return 1;
 
     // Create a directory for each day
     char buffer[1024];
@@ -214,6 +289,28 @@ static void include_utils_tests(void) {
     nob_da_append(&build_paths, "utils/tests/bigint_test");
     nob_da_append(&build_paths, "utils/tests/hashmap_tests");
     nob_da_append(&build_paths, "utils/tests/parsing_helpers_test");
+    nob_da_append(&build_paths, "utils/tests/thread_pool_test");
+    nob_da_append(&build_paths, "utils/tests/work_stealing_test");
+    nob_da_append(&build_paths, "utils/tests/topology_test");
+    nob_da_append(&build_paths, "utils/tests/barrier_test");
+    nob_da_append(&build_paths, "utils/tests/reduce_test");
+    nob_da_append(&build_paths, "utils/tests/parallel_for_test");
+    nob_da_append(&build_paths, "utils/tests/input_stream_test");
+    nob_da_append(&build_paths, "utils/tests/unix_socket_test");
+    nob_da_append(&build_paths, "utils/tests/bench_test");
+    nob_da_append(&build_paths, "utils/tests/perf_counters_test");
+    nob_da_append(&build_paths, "utils/tests/cache_evict_test");
+    nob_da_append(&build_paths, "utils/tests/timer_test");
+    nob_da_append(&build_paths, "utils/tests/gf_profiling_test");
+}
+
+static void include_utils_bench(void) {
+    nob_da_append(&build_paths, "utils/bench/parsing_helpers_bench");
+    nob_da_append(&build_paths, "utils/bench/string_utils_bench");
+    nob_da_append(&build_paths, "utils/bench/hashmap_bench");
+    nob_da_append(&build_paths, "utils/bench/arena_allocator_bench");
+    nob_da_append(&build_paths, "utils/bench/da_bench");
+    nob_da_append(&build_paths, "utils/bench/bigint_bench");
 }
 
 void include_solutions(void) {
@@ -264,8 +361,8 @@ static int build_from_src(void) {
     for (size_t i = 0; i < build_paths.count; ++i) {
 
         /* Who cares about memory leaks in 2025? */
-        Nob_Cmd *cmd = malloc(sizeof (Nob_Cmd));
-        Nob_Cmd *cmd_dbg = malloc(sizeof (Nob_Cmd));
+        Nob_Cmd *cmd = calloc(1, sizeof (Nob_Cmd));
+        Nob_Cmd *cmd_dbg = calloc(1, sizeof (Nob_Cmd));
 
         const char *program_path = build_paths.items[i];
 
@@ -295,11 +392,13 @@ static int build_from_src(void) {
 
         // Optimized version
         nob_cc(cmd);
+        size_t first_flag = cmd->count;
         nob_cc_flags(cmd);
         nob_cmd_append(cmd, "-O3", "-g", "-Wno-unused-function", "-march=znver4","-std=c11", "-DALLOC_STD_IMPL", "-D_DEFAULT_SOURCE");
 #ifdef ENABLE_BENCH
         nob_cmd_append(cmd, "-DENABLE_BENCH");
 #endif
+        append_build_flags(cmd, first_flag);
         nob_cc_output(cmd, output_file);
         nob_cc_inputs(cmd, input_file);
         
@@ -316,12 +415,14 @@ static int build_from_src(void) {
 
         // Debug version
         nob_cc(cmd_dbg);
+        first_flag = cmd_dbg->count;
         nob_cc_flags(cmd_dbg);
         nob_cmd_append(cmd_dbg, "-O0",  "-g", "-Wno-unused-function", "-march=znver4", "-std=c11", "-DALLOC_STD_IMPL","-D_DEFAULT_SOURCE");
         nob_cmd_append(cmd_dbg,  "-DDEBUG_MODE", "-finstrument-functions");
 #ifdef ENABLE_BENCH
         nob_cmd_append(cmd_dbg, "-DENABLE_BENCH");
 #endif
+        append_build_flags(cmd_dbg, first_flag);
         nob_cc_output(cmd_dbg, output_file_dbg);
         nob_cc_inputs(cmd_dbg, input_file);
         
@@ -337,12 +438,424 @@ static int build_from_src(void) {
         }
     }
 
+    if (BUILD_SOLUTIONS) {
+        if (build_all_days(&procs) != 0) return 1;
+    }
+
     // Wait on all the async processes to finish and reset procs dynamic array to 0
     if (!nob_procs_flush(&procs)) return 1;
 
     return 0;
 }
 
+/* Links the solutions of every day that is being compiled into a single program (see solutions/all/main.c) */
+static int build_all_days(Nob_Procs *procs) {
+
+    Nob_Cmd *cmd = malloc(sizeof (Nob_Cmd));
+    cmd->items = NULL;
+    cmd->count = 0;
+    cmd->capacity = 0;
+
+    char *input_file = malloc(MAX_FILE_PATH);
+    strcpy(input_file, base_path);
+    strcat(input_file, SRC_FOLDER"solutions/all/main.c");
+
+    char *output_file = malloc(MAX_FILE_PATH);
+    strcpy(output_file, base_path);
+    strcat(output_file, BUILD_FOLDER"solutions/all/main");
+
+    nob_cc(cmd);
+    size_t first_flag = cmd->count;
+    nob_cc_flags(cmd);
+    nob_cmd_append(cmd, "-O3", "-g", "-Wno-unused-function", "-march=znver4","-std=c11", "-DALLOC_STD_IMPL", "-D_DEFAULT_SOURCE");
+    /* The days only provide their parts, the runner is implemented by solutions/all/main.c */
+    nob_cmd_append(cmd, "-DRUNNER_NO_MAIN");
+    append_build_flags(cmd, first_flag);
+    nob_cc_output(cmd, output_file);
+    nob_cc_inputs(cmd, input_file);
+
+    for (size_t i = 0; i < build_paths.count; ++i) {
+        const char *program_path = build_paths.items[i];
+        if (strncmp(program_path, "solutions/day", strlen("solutions/day")) != 0) continue;
+
+        char *day_file = malloc(MAX_FILE_PATH);
+        strcpy(day_file, base_path);
+        strcat(day_file, SRC_FOLDER);
+        strcat(day_file, program_path);
+        strcat(day_file, ".c");
+        nob_cc_inputs(cmd, day_file);
+    }
+
+    build_info_t command_data;
+    command_data.file = input_file;
+    command_data.directory = base_path;
+    command_data.arguments = cmd;
+    command_data.output = output_file;
+    /* Run it manually, the days already run on their own */
+    command_data.auto_run = false;
+    nob_da_append(&compile_commands, command_data);
+
+    if (BUILD_ASYNC) {
+        if (!nob_cmd_run(cmd, .async = procs, .no_reset = true)) return 1;
+    } else {
+        if (!nob_cmd_run(cmd, .no_reset = true)) return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Builds every day twice, as usual and with the startup profile (statically linked,
+ * see RUNNER_STARTUP_PROFILE in utils/runner.h), then measures the time from exec to
+ * the answers of both with tools/startup_latency.
+ */
+static int startup_report(void) {
+
+    Nob_Procs procs = {0};
+    Nob_Cmd cmd = {0};
+
+    include_solutions();
+
+    const char *harness = BUILD_FOLDER"tools/startup_latency";
+    nob_cc(&cmd);
+    nob_cc_flags(&cmd);
+    nob_cmd_append(&cmd, "-O3", "-g", "-Wno-unused-function", "-march=znver4","-std=c11", "-D_DEFAULT_SOURCE");
+    nob_cc_output(&cmd, harness);
+    nob_cc_inputs(&cmd, SRC_FOLDER"tools/startup_latency.c");
+    if (!nob_cmd_run(&cmd, .async = &procs)) return 1;
+
+    for (size_t i = 0; i < build_paths.count; ++i) {
+        const char *program_path = build_paths.items[i];
+        const char *day_name = program_path + strlen("solutions/");
+
+        char *input_file = malloc(MAX_FILE_PATH);
+        sprintf(input_file, "%s%s.c", SRC_FOLDER, program_path);
+        char *output_default = malloc(MAX_FILE_PATH);
+        snprintf(output_default, MAX_FILE_PATH, "%sstartup/%.5s_default", BUILD_FOLDER, day_name);
+        char *output_startup = malloc(MAX_FILE_PATH);
+        snprintf(output_startup, MAX_FILE_PATH, "%sstartup/%.5s_startup", BUILD_FOLDER, day_name);
+
+        nob_cc(&cmd);
+        nob_cc_flags(&cmd);
+        nob_cmd_append(&cmd, "-O3", "-g", "-Wno-unused-function", "-march=znver4","-std=c11", "-DALLOC_STD_IMPL", "-D_DEFAULT_SOURCE");
+        nob_cc_output(&cmd, output_default);
+        nob_cc_inputs(&cmd, input_file);
+        if (!nob_cmd_run(&cmd, .async = &procs)) return 1;
+
+        nob_cc(&cmd);
+        nob_cc_flags(&cmd);
+        nob_cmd_append(&cmd, "-O3", "-g", "-Wno-unused-function", "-march=znver4","-std=c11", "-DALLOC_STD_IMPL", "-D_DEFAULT_SOURCE");
+        nob_cmd_append(&cmd, "-DRUNNER_STARTUP_PROFILE", "-static");
+        nob_cc_output(&cmd, output_startup);
+        nob_cc_inputs(&cmd, input_file);
+        if (!nob_cmd_run(&cmd, .async = &procs)) return 1;
+    }
+
+    if (!nob_procs_flush(&procs)) return 1;
+
+    for (size_t i = 0; i < build_paths.count; ++i) {
+        const char *day_name = build_paths.items[i] + strlen("solutions/");
+
+        char output_default[MAX_FILE_PATH];
+        snprintf(output_default, MAX_FILE_PATH, "%sstartup/%.5s_default", BUILD_FOLDER, day_name);
+        char output_startup[MAX_FILE_PATH];
+        snprintf(output_startup, MAX_FILE_PATH, "%sstartup/%.5s_startup", BUILD_FOLDER, day_name);
+
+        nob_cmd_append(&cmd, harness, "-n", STARTUP_RUNS, output_default, output_startup);
+        if (!nob_cmd_run(&cmd)) return 1;
+    }
+
+    return 0;
+}
+
+/* Builds the microbenchmarks of the utilities (optimized only) and runs them one after the other */
+static int bench_report(void) {
+
+    Nob_Procs procs = {0};
+    Nob_Cmd cmd = {0};
+
+    include_utils_bench();
+
+    for (size_t i = 0; i < build_paths.count; ++i) {
+        char *input_file = malloc(MAX_FILE_PATH);
+        snprintf(input_file, MAX_FILE_PATH, "%s%s.c", SRC_FOLDER, build_paths.items[i]);
+        char *output_file = malloc(MAX_FILE_PATH);
+        snprintf(output_file, MAX_FILE_PATH, "%s%s", BUILD_FOLDER, build_paths.items[i]);
+
+        nob_cc(&cmd);
+        nob_cc_flags(&cmd);
+        nob_cmd_append(&cmd, "-O3", "-g", "-Wno-unused-function", "-march=znver4","-std=c11", "-DALLOC_STD_IMPL", "-D_DEFAULT_SOURCE");
+        nob_cc_output(&cmd, output_file);
+        nob_cc_inputs(&cmd, input_file);
+        if (!nob_cmd_run(&cmd, .async = &procs)) return 1;
+    }
+
+    if (!nob_procs_flush(&procs)) return 1;
+
+    /* One at a time, so they do not compete for the cores and caches */
+    for (size_t i = 0; i < build_paths.count; ++i) {
+        char program[MAX_FILE_PATH];
+        snprintf(program, sizeof (program), "%s%s", BUILD_FOLDER, build_paths.items[i]);
+
+        nob_cmd_append(&cmd, program);
+        if (!nob_cmd_run(&cmd)) return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Builds tools/gen_input and writes the input of every day at each scale to
+ * build/inputs/x<scale>/day_XX.txt. Run a day on one of them with --batch.
+ */
+static int generate_inputs(int scale_count, char **scales) {
+
+    const char *generator = BUILD_FOLDER"tools/gen_input";
+
+    Nob_Cmd cmd = {0};
+    nob_cc(&cmd);
+    nob_cc_flags(&cmd);
+    nob_cmd_append(&cmd, "-O2", "-std=c11", "-D_DEFAULT_SOURCE");
+    nob_cc_output(&cmd, generator);
+    nob_cc_inputs(&cmd, SRC_FOLDER"tools/gen_input.c");
+    nob_cmd_append(&cmd, "-lm");
+    if (!nob_cmd_run(&cmd)) return 1;
+
+    for (int i = 0; i < scale_count; ++i) {
+        char directory[MAX_FILE_PATH];
+        snprintf(directory, sizeof (directory), "%sinputs/x%s", BUILD_FOLDER, scales[i]);
+        if (!nob_mkdir_if_not_exists(directory)) return 1;
+
+        for (int day = 1; day <= GEN_INPUT_DAYS; ++day) {
+            char day_arg[8];
+            snprintf(day_arg, sizeof (day_arg), "%d", day);
+            char output[MAX_FILE_PATH + 16];
+            snprintf(output, sizeof (output), "%s/day_%02d.txt", directory, day);
+
+            nob_cmd_append(&cmd, generator, day_arg, "-s", scales[i]);
+            if (!nob_cmd_run(&cmd, .stdout_path = output)) return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Records the flags from first_flag on in the program (RUNNER_BUILD_FLAGS in utils/runner.h) */
+static void append_build_flags(Nob_Cmd *cmd, size_t first_flag) {
+
+    Nob_String_Builder sb = {0};
+    nob_sb_append_cstr(&sb, "-DRUNNER_BUILD_FLAGS=\"");
+    for (size_t i = first_flag; i < cmd->count; ++i) {
+        if (i > first_flag) nob_sb_append_cstr(&sb, " ");
+        nob_sb_append_cstr(&sb, cmd->items[i]);
+    }
+    nob_sb_append_cstr(&sb, "\"");
+    nob_sb_append_null(&sb);
+
+    nob_cmd_append(cmd, sb.items);
+}
+
+/* Builds the days and runs each one, appending their benchmark results to results_path */
+static int record_results(const char *results_path) {
+
+    include_solutions();
+    if (build_from_src() != 0) return 1;
+
+    if (nob_file_exists(results_path) > 0 && !nob_delete_file(results_path)) return 1;
+    setenv("AOC_RESULTS", results_path, 1);
+
+    Nob_Cmd cmd = {0};
+    for (size_t i = 0; i < build_paths.count; ++i) {
+        char program[MAX_FILE_PATH];
+        snprintf(program, sizeof (program), "%s%s", BUILD_FOLDER, build_paths.items[i]);
+
+        nob_cmd_append(&cmd, program);
+        /* A day without its input fails, the others are still recorded */
+        if (!nob_cmd_run(&cmd)) nob_log(NOB_WARNING, "%s failed, it has no results", program);
+    }
+
+    nob_log(NOB_INFO, "Results written to %s", results_path);
+
+    return 0;
+}
+
+typedef struct {
+    unsigned long long day;
+    unsigned long long part;
+    unsigned long long threads;
+    unsigned long long median;
+    unsigned long long *samples;
+    size_t sample_count;
+} result_t;
+
+typedef struct {
+    result_t *items;
+    size_t count;
+    size_t capacity;
+} results_t;
+
+/* Reads "key":<number> from a line written by runner_record_results */
+static bool result_field(const char *line, const char *key, unsigned long long *value) {
+    char pattern[64];
+    snprintf(pattern, sizeof (pattern), "\"%s\":", key);
+
+    const char *found = strstr(line, pattern);
+    if (!found) return false;
+
+    *value = strtoull(found + strlen(pattern), NULL, 10);
+    return true;
+}
+
+static bool load_results(const char *path, results_t *results) {
+
+    Nob_String_Builder sb = {0};
+    if (!nob_read_entire_file(path, &sb)) return false;
+    nob_sb_append_null(&sb);
+
+    char *line = sb.items;
+    while (line && *line) {
+        char *end = strchr(line, '\n');
+        if (end) *end = '\0';
+
+        result_t result = {0};
+        const char *samples = strstr(line, "\"samples\":[");
+        bool valid = result_field(line, "day", &result.day) && result_field(line, "part", &result.part)
+                  && result_field(line, "threads", &result.threads) && result_field(line, "median", &result.median)
+                  && samples;
+
+        if (valid) {
+            samples += strlen("\"samples\":[");
+            result.samples = malloc((strlen(samples) / 2 + 1) * sizeof (*result.samples));
+
+            char *next;
+            while (*samples != ']') {
+                result.samples[result.sample_count++] = strtoull(samples, &next, 10);
+                if (next == samples) break;
+                samples = *next == ',' ? next + 1 : next;
+            }
+
+            nob_da_append(results, result);
+        }
+
+        line = end ? end + 1 : NULL;
+    }
+
+    return true;
+}
+
+typedef struct {
+    unsigned long long value;
+    int from_current;
+} ranked_sample_t;
+
+static int compare_ranked(const void *a, const void *b) {
+    unsigned long long x = ((const ranked_sample_t *)a)->value;
+    unsigned long long y = ((const ranked_sample_t *)b)->value;
+    return (x > y) - (x < y);
+}
+
+/* Newton's method, so nob does not have to be linked with libm */
+static double square_root(double x) {
+    if (x <= 0.0) return 0.0;
+
+    double root = x > 1.0 ? x : 1.0;
+    for (int i = 0; i < 64; ++i) root = (root + x / root) / 2.0;
+
+    return root;
+}
+
+/*
+ * Mann-Whitney U test (normal approximation, ties get their average rank).
+ *
+ * Returns:
+ *     The z score, positive when the current samples tend to be slower.
+ */
+static double mann_whitney_z(const result_t *baseline, const result_t *current) {
+
+    size_t n1 = baseline->sample_count;
+    size_t n2 = current->sample_count;
+    if (n1 == 0 || n2 == 0) return 0.0;
+
+    ranked_sample_t *all = malloc((n1 + n2) * sizeof (*all));
+    for (size_t i = 0; i < n1; ++i) all[i]      = (ranked_sample_t) { baseline->samples[i], 0 };
+    for (size_t i = 0; i < n2; ++i) all[n1 + i] = (ranked_sample_t) { current->samples[i], 1 };
+    qsort(all, n1 + n2, sizeof (*all), compare_ranked);
+
+    double rank_sum = 0.0;
+    for (size_t i = 0; i < n1 + n2;) {
+        size_t j = i;
+        while (j < n1 + n2 && all[j].value == all[i].value) ++j;
+
+        /* Ranks i + 1 to j share their average */
+        double rank = (double)(i + 1 + j) / 2.0;
+        for (size_t k = i; k < j; ++k) {
+            if (all[k].from_current) rank_sum += rank;
+        }
+        i = j;
+    }
+    free(all);
+
+    double u     = rank_sum - (double)n2 * (n2 + 1) / 2.0;
+    double mean  = (double)n1 * n2 / 2.0;
+    double sigma = square_root((double)n1 * n2 * (n1 + n2 + 1) / 12.0);
+
+    return sigma > 0.0 ? (u - mean) / sigma : 0.0;
+}
+
+/* Compares every part of the current results with the same part (and thread count) in the baseline */
+static int compare_results(const char *baseline_path, const char *current_path) {
+
+    results_t baseline = {0};
+    results_t current  = {0};
+    if (!load_results(baseline_path, &baseline)) return 1;
+    if (!load_results(current_path, &current)) return 1;
+
+    size_t regressions = 0;
+
+    printf("%-4s %-5s %-8s %16s %16s %9s %8s\n", "day", "part", "threads", "baseline (ns)", "current (ns)", "change", "z");
+
+    for (size_t i = 0; i < current.count; ++i) {
+        const result_t *now = &current.items[i];
+
+        const result_t *before = NULL;
+        for (size_t j = 0; j < baseline.count && !before; ++j) {
+            const result_t *candidate = &baseline.items[j];
+            if (candidate->day == now->day && candidate->part == now->part && candidate->threads == now->threads) {
+                before = candidate;
+            }
+        }
+
+        if (!before) {
+            printf("%-4llu %-5llu %-8llu %16s %16llu   (no baseline)\n", now->day, now->part, now->threads, "-", now->median);
+            continue;
+        }
+
+        double change = before->median > 0 ? (double)now->median / (double)before->median - 1.0 : 0.0;
+        double z      = mann_whitney_z(before, now);
+
+        const char *verdict = "";
+        if (z > COMPARE_Z_THRESHOLD && change > COMPARE_MIN_CHANGE) {
+            verdict = "  REGRESSION";
+            ++regressions;
+        } else if (z < -COMPARE_Z_THRESHOLD && change < -COMPARE_MIN_CHANGE) {
+            verdict = "  faster";
+        }
+
+        printf("%-4llu %-5llu %-8llu %16llu %16llu %+8.2f%% %8.2f%s\n",
+                now->day, now->part, now->threads, before->median, now->median, change * 100.0, z, verdict);
+    }
+
+    fflush(stdout);
+
+    if (regressions > 0) {
+        nob_log(NOB_ERROR, "%zu significant regression(s) against %s", regressions, baseline_path);
+        return 1;
+    }
+
+    nob_log(NOB_INFO, "No significant regressions against %s", baseline_path);
+    return 0;
+}
+
 static int gen_compile_commands(void *cmds) {
 
     compile_commands_t *commands = cmds;
@@ -369,7 +882,12 @@ static int gen_compile_commands(void *cmds) {
         fprintf(output, "        \"arguments\": [\n");
         for (size_t j = 0; j < cmd.arguments->count; ++j) {
             const char* arg = cmd.arguments->items[j];
-            fprintf(output, "        \"%s\"", arg);
+            fputs("        \"", output);
+            for (const char *c = arg; *c; ++c) {
+                if (*c == '"' || *c == '\\') fputc('\\', output);
+                fputc(*c, output);
+            }
+            fputs("\"", output);
 
             if (j == cmd.arguments->count - 1) {
                 fputs("\n", output);
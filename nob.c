@@ -7,6 +7,8 @@
 #include "build_config/dirs.h"
 
 static _Bool defconfig = false;
+/* Every other argument is passed on to nob_configed (e.g. ./nob startup) */
+static Nob_Cmd forwarded_args = {0};
 
 void parse_args(int argc, char **argv);
 
@@ -34,6 +36,7 @@ int main(int argc, char **argv)
         sb_append_cstr(&sb, "static const unsigned int COMPILE_SOLUTIONS[] = {0};\n");
         sb_append_cstr(&sb, "#define BUILD_SOLUTIONS   1    /* Compile the solutions for each day */\n");
         sb_append_cstr(&sb, "#define BUILD_UTILS_TESTS 0    /* Compile the tests for the utilities */\n");
+        sb_append_cstr(&sb, "#define BUILD_UTILS_BENCH 0    /* Compile the microbenchmarks for the utilities (./nob bench runs them) */\n");
         sb_append_cstr(&sb, "#define BUILD_ASYNC 1          /* Compile programs concurrently */\n");
 
         /* ----- Run options ----- */
@@ -70,6 +73,7 @@ int main(int argc, char **argv)
     if (!cmd_run(&cmd)) return 1;
 
     cmd_append(&cmd, output_path);
+    nob_cmd_extend(&cmd, &forwarded_args);
     if (!cmd_run(&cmd)) return 1;
 
     return EXIT_SUCCESS;
@@ -77,8 +81,16 @@ int main(int argc, char **argv)
 
 void parse_args(int argc, char **argv) {
 
+    /* Skip the program name */
+    nob_shift(argv, argc);
+
     while(argc > 0) {
-        defconfig = strcmp(nob_shift(argv, argc), "defconfig") == 0;
+        const char *arg = nob_shift(argv, argc);
+        if (strcmp(arg, "defconfig") == 0) {
+            defconfig = true;
+        } else {
+            nob_cmd_append(&forwarded_args, arg);
+        }
     }
 
 }
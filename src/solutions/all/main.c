@@ -0,0 +1,206 @@
+/*
+ * Runs every day in a single process and reports the time of each one against the
+ * goal of running all solutions under 10 ms.
+ *
+ * The days are compiled separately with RUNNER_NO_MAIN and linked into this program,
+ * so they share the arenas and the worker threads and only pay the process startup
+ * once. Days that were not linked are skipped (aoc_day_XX are weak symbols).
+ *
+ * Usage: main [--concurrent] [--rounds N]
+ *     --concurrent - Run the days at the same time, one thread per day, instead of
+ *                    one after the other with the thread counts of each part.
+ *     --rounds N   - How many times to run all the days, the best time is reported.
+ */
+
+/* Needed for thread pinning (pthread_setaffinity_np) */
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Room for the inputs of every day */
+#define RUNNER_FILE_CAP (4 * 1024 * 1024)
+#define RUNNER_IMPL
+#include "../../utils/runner.h"
+
+#define ALL_DAYS_BUDGET_NS (10 * 1000 * 1000)
+
+#ifndef ALL_DAYS_ROUNDS
+#define ALL_DAYS_ROUNDS 16
+#endif /* ifndef ALL_DAYS_ROUNDS */
+
+#define AOC_DAYS(X) \
+    X(01) X(02) X(03) X(04) X(05) X(06) X(07) X(08) X(09) X(10) X(11) X(12) X(13) \
+    X(14) X(15) X(16) X(17) X(18) X(19) X(20) X(21) X(22) X(23) X(24) X(25)
+
+#define DECLARE_DAY(n) extern runner_day_t aoc_day_##n __attribute__((weak));
+AOC_DAYS(DECLARE_DAY)
+
+#define DAY_ADDRESS(n) &aoc_day_##n,
+global_var runner_day_t *linked_days[] = { AOC_DAYS(DAY_ADDRESS) };
+
+#define MAX_DAYS (sizeof (linked_days) / sizeof (linked_days[0]))
+
+typedef struct {
+    runner_day_t    *day;
+    /* Only used when running concurrently, since the arenas are not thread safe */
+    arena_context_t  arena_ctx;
+    allocator_t      arena;
+    /* Time of each part in the current round */
+    u64              part_times[RUNNER_PART_COUNT];
+    /* Best total time of the day over all rounds */
+    u64              best_time;
+} day_slot_t;
+
+global_var day_slot_t slots[MAX_DAYS];
+global_var size_t     slot_count;
+
+/* Runs every part of the day once, can be used as a thread pool task */
+internal void *run_day(void *arg) {
+
+    day_slot_t *slot = arg;
+
+    for (size_t i = 0; i < RUNNER_PART_COUNT; ++i) {
+        runner_part_t *part = &slot->day->parts[i];
+        slot->part_times[i] = 0;
+
+        if (!part->solve) continue;
+
+        u64 clock_start = now_ns();
+        runner_run_part(part);
+        u64 clock_end = now_ns();
+
+        slot->part_times[i] = clock_end - clock_start;
+    }
+
+    return NULL;
+}
+
+internal void print_answers(void) {
+
+    for (size_t i = 0; i < slot_count; ++i) {
+        for (size_t j = 0; j < RUNNER_PART_COUNT; ++j) {
+            runner_part_t *part = &slots[i].day->parts[j];
+            if (!part->solve) continue;
+
+            printf("Day %02u part %zu: ", slots[i].day->number, j + 1);
+            string_println(&part->common.output);
+        }
+    }
+}
+
+internal void reset_arenas(bool concurrent) {
+
+    if (concurrent) {
+        for (size_t i = 0; i < slot_count; ++i) arena_reset(&slots[i].arena_ctx);
+    } else {
+        arena_reset(runner_solution_arena.alloc_ctx);
+    }
+}
+
+int main(int argc, char **argv) {
+
+    bool   concurrent = false;
+    size_t rounds     = ALL_DAYS_ROUNDS;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--concurrent") == 0) {
+            concurrent = true;
+        } else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            rounds = strtoul(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "Usage: %s [--concurrent] [--rounds N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (rounds == 0) rounds = 1;
+
+    u64 setup_start = now_ns();
+
+    runner_init();
+
+    size_t max_threads = 1;
+
+    for (size_t i = 0; i < MAX_DAYS; ++i) {
+        runner_day_t *day = linked_days[i];
+        if (!day) continue;
+
+        if (!runner_load_day(day)) {
+            fprintf(stderr, "Could not read inputs/day_%02u.txt, skipping day %02u\n", day->number, day->number);
+            continue;
+        }
+
+        day_slot_t *slot = &slots[slot_count++];
+        slot->day       = day;
+        slot->best_time = UINT64_MAX;
+
+        /* When running concurrently, each day runs on a single thread with an arena of its own */
+        if (concurrent) {
+            slot->arena_ctx       = arena_init(4096, ARENA_FAST_ALLOC | ARENA_GROWABLE | ARENA_VIRTUAL_BACKEND, NULL, NULL);
+            slot->arena.alloc_ctx = &slot->arena_ctx;
+            slot->arena.interface = &arena_interface;
+        }
+
+        for (size_t j = 0; j < RUNNER_PART_COUNT; ++j) {
+            runner_part_t *part = &day->parts[j];
+
+            if (concurrent) {
+                part->common.arena = &slot->arena;
+                runner_set_thread_count(part, 1);
+            }
+
+            max_threads = (max(max_threads, part->common.thread_count));
+        }
+    }
+
+    if (slot_count == 0) {
+        fprintf(stderr, "No days to run\n");
+        return 1;
+    }
+
+    if (concurrent) max_threads = (max(max_threads, slot_count));
+    runner_start_pool(max_threads - 1);
+
+    u64 setup_end = now_ns();
+
+    printf("\n==== All days (%s, best of %zu rounds) ====\n", concurrent ? "concurrent" : "sequential", rounds);
+    printf("Thread pinning: %s\n", pin_policy_names[runner_pin_policy]);
+    printf("Setup: %'lu ns\n", setup_end - setup_start);
+
+    u64 best_total = UINT64_MAX;
+
+    for (size_t round = 0; round < rounds; ++round) {
+
+        u64 clock_start = now_ns();
+        if (concurrent) {
+            thread_pool_run(&runner_pool, run_day, slots, sizeof (slots[0]), slot_count);
+        } else {
+            for (size_t i = 0; i < slot_count; ++i) run_day(&slots[i]);
+        }
+        u64 clock_end = now_ns();
+
+        if (round == 0) print_answers();
+        reset_arenas(concurrent);
+
+        best_total = (min(best_total, clock_end - clock_start));
+
+        for (size_t i = 0; i < slot_count; ++i) {
+            u64 day_time = 0;
+            for (size_t j = 0; j < RUNNER_PART_COUNT; ++j) day_time += slots[i].part_times[j];
+
+            slots[i].best_time = (min(slots[i].best_time, day_time));
+        }
+    }
+
+    for (size_t i = 0; i < slot_count; ++i) {
+        printf("Day %02u: %'12lu ns (%5.2f%% of the budget)\n", slots[i].day->number,
+                slots[i].best_time, 100.0 * slots[i].best_time / ALL_DAYS_BUDGET_NS);
+    }
+
+    printf("Total:  %'12lu ns (%5.2f%% of the budget) - %s\n", best_total,
+            100.0 * best_total / ALL_DAYS_BUDGET_NS,
+            best_total <= ALL_DAYS_BUDGET_NS ? "under 10 ms" : "OVER 10 ms");
+
+    return 0;
+}
@@ -2,6 +2,7 @@
 #define PART_1_IMPL
 
 #define P1_THREADS 1
+#define P1_BARRIER BARRIER_SPIN
 
 /* Shared data between threads */
 struct p1_data {
@@ -11,51 +12,56 @@ static p1_data p1;
 
 /* Functions for part 1 */
 
-void *p1_solve(void *arg) {
+internal void *p1_solve(void *arg) {
 
     struct part_context *ctx = arg;
 
     /* IO and synchronization */
-    string_t *input = ctx->common->input;
-    size_t thread_count = ctx->common->thread_count;
     size_t thread_idx   = ctx->thread_idx;
 
     UNUSED(p1);
-    UNUSED(input);
 
 
     i16 result = 50;
     u16 count = 0;
-    string_t parsed_input = *input;
 
-    while (parsed_input.count > 0) {
+    /* Parsing and solving are done in a single pass, reading the input a chunk at a time
+     * so it can run while the input is streamed. The dial is sequential, so a single
+     * thread reads every chunk. */
+    part_phase(ctx, PHASE_COMPUTE);
 
-        bool positive;
-        if (parsed_input.chars[0] == 'R') {
-            positive = true;
-        } else {
-            positive = false;
-        }
+    string_t parsed_input;
+    while (thread_idx == 0 && part_input_next(ctx, &parsed_input)) {
+        while (parsed_input.count > 0) {
 
-        skip_n_chars(parsed_input, &parsed_input, 1);
-        
-        i16 number = parse_i16(parsed_input, &parsed_input);
+            bool positive;
+            if (parsed_input.chars[0] == 'R') {
+                positive = true;
+            } else {
+                positive = false;
+            }
 
-        skip_whitespace(parsed_input, &parsed_input);
+            skip_n_chars(parsed_input, &parsed_input, 1);
+    
+            i16 number = parse_i16(parsed_input, &parsed_input);
 
-        if (positive) {
-            result += number;
-        } else {
-            result -= number;
-        }
+            skip_whitespace(parsed_input, &parsed_input);
 
-        result = (result + 100) % 100;
+            if (positive) {
+                result += number;
+            } else {
+                result -= number;
+            }
 
-        if (result == 0) count++;
+            result = (result + 100) % 100;
+
+            if (result == 0) count++;
+        }
     }
 
+    part_phase(ctx, PHASE_FINALIZE);
 
-    if (thread_idx == thread_count - 1) {
+    if (thread_idx == 0) {
         string_builder_t sb = sb_from_u64(count, ctx->common->arena);
         ctx->common->output = sb_build(&sb);
     }
@@ -1,5 +1,7 @@
 #ifndef PRELUDE_H
 #define PRELUDE_H
+/* Needed for thread pinning (pthread_setaffinity_np) */
+#define _GNU_SOURCE
 /* ----------------------------------------
  * Time measurement
  * ---------------------------------------- */
@@ -37,6 +39,13 @@
 #include "../../utils/string_utils.h" // IWYU pragma: export
 #include "../../utils/parsing_helpers.h" // IWYU pragma: export
 
+/* Runner (input, arenas, worker threads, benchmarks), implemented by the all-days binary
+ * when the day is linked into it */
+#ifndef RUNNER_NO_MAIN
+#define RUNNER_IMPL
+#endif
+#include "../../utils/runner.h" // IWYU pragma: export
+
 
 
 /* Structure for testing */
@@ -46,42 +55,15 @@ typedef struct p2_test_data p2_test_data;
 static inline void test_p1();
 static inline void test_p2();
 
-/* Infrastructure for each part */
-struct part_context_common {
-    pthread_barrier_t barrier;
-    size_t            thread_count;
-    string_t          output;
-    string_t         *input;
-    allocator_t      *arena;
-    void             *test_data;
-    bool             is_test;
-};
-
-struct part_context {
-    size_t thread_idx;
-    struct part_context_common *common;
-};
-
 /* Data shared between threads for each part */
 typedef struct p1_data p1_data;
 typedef struct p2_data p2_data;
 
 
 static inline void p1_setup(struct part_context *ctx);
-void *p1_solve(void *ctx);
+internal void *p1_solve(void *ctx);
 
 static inline void p2_setup(struct part_context *ctx);
-void *p2_solve(void *ctx);
-
-/* Common utilities */
-internal inline void sync_all(struct part_context *ctx) {
-    if (ctx->common->thread_count > 1) pthread_barrier_wait(&ctx->common->barrier);
-}
-
-static inline uint64_t now_ns(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
-}
+internal void *p2_solve(void *ctx);
 
 #endif /* ifndef PRELUDE_H */
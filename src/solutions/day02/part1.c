@@ -1,20 +1,25 @@
 #include "prelude.h"
 #include <assert.h>
-#include <stdatomic.h>
 #include <immintrin.h>
 #include <stdint.h>
 #include <string.h>
 #define PART_1_IMPL
 
 #define P1_THREADS 16
+#define P1_BARRIER BARRIER_SPIN
 
 #define P1_MAX_RANGES 500
 
 /* Shared data between threads */
 struct p1_data {
-    range_inclusive_t ranges[P1_MAX_RANGES];
-    u16 range_count;
-    atomic_uint_fast64_t invalid_total;
+    range_inclusive_t range_storage[P1_MAX_RANGES];
+    u64 weight_storage[P1_MAX_RANGES + 1];
+    /* Point to the storage above, or to the arena for bigger inputs */
+    range_inclusive_t *ranges;
+    size_t range_count;
+    /* Prefix sums of the range lengths, the cost of a range is the number of ids to check */
+    u64 *weights;
+    parallel_for_t loop;
 };
 
 static p1_data p1;
@@ -22,7 +27,7 @@ static p1_data p1;
 /* Functions for part 1 */
 internal void p1_count_invalid_ids(struct part_context*);
 
-void *p1_solve(void *arg) {
+internal void *p1_solve(void *arg) {
 
     struct part_context *ctx = arg;
 
@@ -35,13 +40,17 @@ void *p1_solve(void *arg) {
     }
 
     sync_all(ctx);
-    
+
+    part_phase(ctx, PHASE_COMPUTE);
+
     p1_count_invalid_ids(ctx);
 
     sync_all(ctx);
 
+    part_phase(ctx, PHASE_FINALIZE);
+
     if (thread_idx == thread_count - 1) {
-        string_builder_t sb = sb_from_u64(p1.invalid_total, ctx->common->arena);
+        string_builder_t sb = sb_from_u64(part_reduce_sum(ctx), ctx->common->arena);
         ctx->common->output = sb_build(&sb);
     }
 
@@ -54,7 +63,21 @@ static inline void p1_setup(struct part_context *ctx) {
 
     string_t to_parse = *input;
 
-    while (to_parse.count > 0) {
+    /* One range per comma, plus the last one */
+    size_t max_ranges = 1;
+    for (size_t i = 0; i < input->count; ++i) {
+        max_ranges += input->chars[i] == ',';
+    }
+
+    p1.ranges = max_ranges <= P1_MAX_RANGES
+        ? p1.range_storage
+        : allocator_alloc(ctx->common->arena, max_ranges * sizeof (range_inclusive_t));
+    p1.weights = max_ranges <= P1_MAX_RANGES
+        ? p1.weight_storage
+        : allocator_alloc(ctx->common->arena, (max_ranges + 1) * sizeof (u64));
+
+    p1.range_count = 0;
+    while (to_parse.count > 0 && p1.range_count < max_ranges) {
 
         range_inclusive_t new_range;
 
@@ -69,53 +92,60 @@ static inline void p1_setup(struct part_context *ctx) {
 
         p1.ranges[p1.range_count++] = new_range;
     }
+
+    p1.weights[0] = 0;
+    for (size_t i = 0; i < p1.range_count; ++i) {
+        p1.weights[i + 1] = p1.weights[i] + (p1.ranges[i].end - p1.ranges[i].start + 1);
+    }
+
+    /* Range lengths vary by orders of magnitude, so threads claim chunks of similar weight */
+    parallel_for_init(&p1.loop, PARALLEL_DYNAMIC, p1.range_count, p1.weights, 1, ctx->common->thread_count);
 }
 
 internal void p1_count_invalid_ids(struct part_context *ctx) {
 
-    size_t thread_count = ctx->common->thread_count;
     size_t thread_idx   = ctx->thread_idx;
-    
-    const size_t tasks_per_thread = p1.range_count / thread_count;
-    const size_t remainders = p1.range_count % thread_count;
 
-    const bool take_remainder = thread_idx < remainders;
-    const size_t prev_remainders = take_remainder ? thread_idx : remainders;
+    size_t start;
+    size_t end;
+    parallel_for_iter_t it = parallel_for_begin(&p1.loop, thread_idx);
 
-    const size_t start = thread_idx * tasks_per_thread + prev_remainders;
-    const size_t end = start + tasks_per_thread + (take_remainder ? 1 : 0);
+    u64 local_total = 0;
 
+    while (parallel_for_next(&it, &start, &end)) {
+        for (size_t i = start; i < end; ++i) {
+            u8 local_buffer[256];
+            allocator_t local_arena = {
+                .interface = &arena_interface,
+                .alloc_ctx = arena_from_buf(local_buffer, 256)
+            };
 
-    for (size_t i = start; i < end; ++i) {
-        u8 local_buffer[256];
-        allocator_t local_arena = {
-            .interface = &arena_interface,
-            .alloc_ctx = arena_from_buf(local_buffer, 256)
-        };
+            range_inclusive_t range = p1.ranges[i];
 
-        range_inclusive_t range = p1.ranges[i];
+            for (u64 curr = range.start; curr <= range.end; ++curr) {
+                arena_reset(local_arena.alloc_ctx);
 
-        for (u64 curr = range.start; curr <= range.end; ++curr) {
-            arena_reset(local_arena.alloc_ctx);
+                string_builder_t sb = sb_from_u64(curr, &local_arena);
 
-            string_builder_t sb = sb_from_u64(curr, &local_arena);
+                if (sb.array_info.count % 2 != 0) {
+                    continue;
+                }
 
-            if (sb.array_info.count % 2 != 0) {
-                continue;
-            }
+                u8 mid = sb.array_info.count/2;
 
-            u8 mid = sb.array_info.count/2;
+                /* 128-bit = 16x8-bit, we expect less than 20 characters per number,
+                 * therefore less than 10 characters per half */
+                __m128i a = {0};
+                __m128i b = {0};
+                memcpy(&a, sb.items, mid);
+                memcpy(&b, &sb.items[mid], mid);
 
-            /* 128-bit = 16x8-bit, we expect less than 20 characters per number,
-             * therefore less than 10 characters per half */
-            __m128i a = {0};
-            __m128i b = {0};
-            memcpy(&a, sb.items, mid);
-            memcpy(&b, &sb.items[mid], mid);
-
-            __mmask32 mask = _mm_cmp_epu8_mask(a, b, _MM_CMPINT_EQ);
-            if (mask == 0xFFFF)
-                atomic_fetch_add(&p1.invalid_total, curr);
+                __mmask32 mask = _mm_cmp_epu8_mask(a, b, _MM_CMPINT_EQ);
+                if (mask == 0xFFFF)
+                    local_total += curr;
+            }
         }
     }
+
+    part_reduce_store(ctx, local_total);
 }
@@ -1,24 +1,22 @@
 #include "prelude.h"
-#include <stdatomic.h>
 #include <stddef.h>
 #define PART_2_IMPL
 
 #define P2_THREADS 1
-#define CHARS_PER_LINE 101
-#define LINE_COUNT 200
+#define P2_BARRIER BARRIER_SPIN
+#define P2_LINE_LENGTH 100
 
 /* Shared data between threads */
 struct p2_data {
-    atomic_uint_fast64_t total_joltage;
 };
 
 static p2_data p2;
 static inline void p2_calculate(struct part_context *ctx);
 
 /* Functions for part 2 */
-static inline void p2_find_earliest_biggest_digit(string_t input, size_t pos, u8 *digit, u8 *index);
+static inline void p2_find_earliest_biggest_digit(string_t input, size_t pos, u8 *digit, size_t *index);
 
-void *p2_solve(void *arg) {
+internal void *p2_solve(void *arg) {
 
     struct part_context *ctx = arg;
 
@@ -30,11 +28,16 @@ void *p2_solve(void *arg) {
     UNUSED(p2);
     UNUSED(input);
 
+    /* No setup, the lines are parsed where they are */
+    part_phase(ctx, PHASE_COMPUTE);
+
     p2_calculate(ctx);
     sync_all(ctx);
 
+    part_phase(ctx, PHASE_FINALIZE);
+
     if (thread_idx == thread_count - 1) {
-        string_builder_t sb = sb_from_u64(p2.total_joltage, ctx->common->arena);
+        string_builder_t sb = sb_from_u64(part_reduce_sum(ctx), ctx->common->arena);
         ctx->common->output = sb_build(&sb);
     }
 
@@ -42,20 +45,16 @@ void *p2_solve(void *arg) {
 }
 
 
-static inline void p2_calculate(struct part_context *ctx) {
+static force_inline void p2_calculate_lines(struct part_context *ctx, size_t line_length, size_t line_ending_length, size_t line_count) {
 
     string_t *input = ctx->common->input;
-    size_t thread_count = ctx->common->thread_count;
-    size_t thread_idx   = ctx->thread_idx;
-    
-    const size_t tasks_per_thread = LINE_COUNT / thread_count;
-    const size_t remainders = LINE_COUNT % thread_count;
 
-    const bool take_remainder = thread_idx < remainders;
-    const size_t prev_remainders = take_remainder ? thread_idx : remainders;
+    /* Every line is followed by a "\n" (or "\r\n") */
+    const size_t chars_per_line = line_length + line_ending_length;
 
-    const size_t start_line = thread_idx * tasks_per_thread + prev_remainders;
-    const size_t end_line = start_line + tasks_per_thread + (take_remainder ? 1 : 0);
+    size_t start_line;
+    size_t end_line;
+    split_by_thread(ctx, line_count, &start_line, &end_line);
 
     u64 local_joltage = 0;
     for (size_t line_idx = start_line; line_idx < end_line; ++line_idx) {
@@ -63,8 +62,9 @@ static inline void p2_calculate(struct part_context *ctx) {
         u64 line_joltage = 0;
 
         string_t line = {
-            .chars = &input->chars[line_idx * CHARS_PER_LINE],
-            .count = CHARS_PER_LINE
+            .chars = &input->chars[line_idx * chars_per_line],
+            /* The digits and the first char of the line ending, even with "\r\n" */
+            .count = line_length + 1
         };
 
         u64 pow_10 =  10l * 10 * 10 * 10
@@ -73,7 +73,7 @@ static inline void p2_calculate(struct part_context *ctx) {
 
         for (u8 pos = 12; pos > 0; --pos) {
             u8 digit;
-            u8 index;
+            size_t index;
 
             p2_find_earliest_biggest_digit(line, pos, &digit, &index);
             skip_n_chars(line, &line, index + 1);
@@ -85,10 +85,22 @@ static inline void p2_calculate(struct part_context *ctx) {
         local_joltage += line_joltage;
     }
 
-    atomic_fetch_add(&p2.total_joltage, local_joltage);
+    part_reduce_store(ctx, local_joltage);
+}
+
+static inline void p2_calculate(struct part_context *ctx) {
+
+    const input_shape_t *shape = ctx->common->shape;
+    assert(shape->uniform && "Every line must have the same length");
+
+    if (shape->line_length == P2_LINE_LENGTH && shape->line_ending_length == 1) {
+        p2_calculate_lines(ctx, P2_LINE_LENGTH, 1, shape->section_lines[0]);
+    } else {
+        p2_calculate_lines(ctx, shape->line_length, shape->line_ending_length, shape->section_lines[0]);
+    }
 }
 
-static inline void p2_find_earliest_biggest_digit(string_t input, size_t pos, u8 *digit, u8 *index) {
+static inline void p2_find_earliest_biggest_digit(string_t input, size_t pos, u8 *digit, size_t *index) {
 
     *digit = 0;
     *index = 0;
@@ -1,61 +1,76 @@
 #include "prelude.h"
-#include <stdatomic.h>
 #include <stddef.h>
 #include <threads.h>
 #define PART_1_IMPL
 
 #define P1_THREADS 1
+#define P1_BARRIER BARRIER_SPIN
 
+/* Size of the grid of the puzzle inputs, which gets a specialized kernel */
 #define GRID_ROWS 135
 #define GRID_COLS 135
 
 /* Shared data between threads */
 struct p1_data {
-    u8 grid[GRID_ROWS][GRID_COLS];
-    atomic_uint_least16_t accessible_rolls;
+    /* Grids larger than the ones of the puzzle inputs are allocated from the arena */
+    u8 grid_storage[GRID_ROWS * GRID_COLS];
+    u8 *grid;
+    size_t rows;
+    size_t cols;
+    /* Chars from one row of the input to the next, with the line ending */
+    size_t stride;
 };
 
 static p1_data p1;
 
 /* Functions for part 1 */
+static force_inline void p1_count_accessible(struct part_context *ctx, size_t rows, size_t cols, size_t stride);
 
-void *p1_solve(void *arg) {
+internal void *p1_solve(void *arg) {
 
     struct part_context *ctx = arg;
 
     /* IO and synchronization */
-    string_t *input = ctx->common->input;
     size_t thread_count = ctx->common->thread_count;
     size_t thread_idx   = ctx->thread_idx;
 
-    UNUSED(p1);
-    UNUSED(input);
+    if (thread_idx == 0) {
+        p1_setup(ctx);
+    }
+
+    sync_all(ctx);
 
-    p1_setup(ctx);
+    if (p1.rows == GRID_ROWS && p1.cols == GRID_COLS && p1.stride == GRID_COLS + 1) {
+        p1_count_accessible(ctx, GRID_ROWS, GRID_COLS, GRID_COLS + 1);
+    } else {
+        p1_count_accessible(ctx, p1.rows, p1.cols, p1.stride);
+    }
 
     sync_all(ctx);
 
+    part_phase(ctx, PHASE_FINALIZE);
+
     if (thread_idx == thread_count - 1) {
-        string_builder_t sb = sb_from_u64(p1.accessible_rolls, ctx->common->arena);
+        string_builder_t sb = sb_from_u64(part_reduce_sum(ctx), ctx->common->arena);
         ctx->common->output = sb_build(&sb);
     }
 
     return NULL;
 }
 
-static inline u8 p1_count_neighbors(size_t x, size_t y) {
+static force_inline u8 p1_count_neighbors(size_t x, size_t y, size_t rows, size_t cols) {
 
     u8 result = 0;
 
     for (i8 dx = -1; dx <= 1; ++dx) {
         for (i8 dy = -1; dy <= 1; ++dy) {
-            i16 check_x = x + dx;
-            i16 check_y = y + dy;
+            i64 check_x = (i64)x + dx;
+            i64 check_y = (i64)y + dy;
 
             if ((dx != 0 || dy != 0) 
-                    && (check_x >= 0 && check_x < GRID_COLS)
-                    && (check_y >= 0 && check_y < GRID_ROWS)
-                    && (p1.grid[check_y][check_x] == PAPER_ROLL)) {
+                    && (check_x >= 0 && check_x < (i64)cols)
+                    && (check_y >= 0 && check_y < (i64)rows)
+                    && (p1.grid[check_y * cols + check_x] == PAPER_ROLL)) {
                 ++result;
             }
         }
@@ -65,41 +80,63 @@ static inline u8 p1_count_neighbors(size_t x, size_t y) {
 
 }
 
+/* Sizes the grid from the shape of the input */
 static inline void p1_setup(struct part_context *ctx) {
 
+    const input_shape_t *shape = ctx->common->shape;
+    assert(shape->uniform && "Every row must have the same length");
+
+    p1.rows = shape->section_lines[0];
+    p1.cols = shape->line_length;
+    p1.stride = shape->line_length + shape->line_ending_length;
+
+    if (p1.rows * p1.cols <= sizeof (p1.grid_storage)) {
+        p1.grid = p1.grid_storage;
+    } else {
+        p1.grid = allocator_alloc(ctx->common->arena, p1.rows * p1.cols);
+    }
+}
+
+static force_inline void p1_count_accessible(struct part_context *ctx, size_t rows, size_t cols, size_t stride) {
+
     string_t *input = ctx->common->input;
 
     size_t start_row;
     size_t end_row;
-    split_by_thread(ctx, GRID_ROWS, &start_row, &end_row);
+    split_by_thread(ctx, rows, &start_row, &end_row);
 
     for (size_t y = start_row; y < end_row; ++y) {
 
-        for (size_t x = 0; x < GRID_COLS; ++x) {
+        for (size_t x = 0; x < cols; ++x) {
 
-            size_t char_idx = (GRID_COLS + 1) * y + x;
+            size_t char_idx = stride * y + x;
 
             switch (input->chars[char_idx]){
             case '@':
-                p1.grid[y][x] = PAPER_ROLL;
+                p1.grid[y * cols + x] = PAPER_ROLL;
                 break;
             case '.': 
             default:
-                p1.grid[y][x] = EMPTY;
+                p1.grid[y * cols + x] = EMPTY;
                 break;
             }
         
         }
     }
 
+    /* Neighbors may be in rows parsed by other threads */
+    sync_all(ctx);
+
+    part_phase(ctx, PHASE_COMPUTE);
+
     u32 locally_accessible = 0;
     for (size_t y = start_row; y < end_row; ++y) {
-        for (size_t x = 0; x < GRID_COLS; ++x) {
-            if ((p1.grid[y][x]) && p1_count_neighbors(x, y) < 4) {
+        for (size_t x = 0; x < cols; ++x) {
+            if ((p1.grid[y * cols + x]) && p1_count_neighbors(x, y, rows, cols) < 4) {
                 ++locally_accessible;
             }
         }
     }
 
-    atomic_fetch_add(&p1.accessible_rolls, locally_accessible);
+    part_reduce_store(ctx, locally_accessible);
 }
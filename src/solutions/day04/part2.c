@@ -2,55 +2,73 @@
 #define PART_2_IMPL
 
 #define P2_THREADS 1
+#define P2_BARRIER BARRIER_SPIN
 
+/* Size of the grid of the puzzle inputs, which gets a specialized kernel */
 #define GRID_ROWS 135
 #define GRID_COLS 135
 
 /* Shared data between threads */
 struct p2_data {
-    u8 grid[GRID_ROWS][GRID_COLS];
-    atomic_uint_least16_t accessible_rolls;
+    /* Grids larger than the ones of the puzzle inputs are allocated from the arena */
+    u8 grid_storage[GRID_ROWS * GRID_COLS];
+    u8 *grid;
+    size_t rows;
+    size_t cols;
+    /* Chars from one row of the input to the next, with the line ending */
+    size_t stride;
 };
 
 static p2_data p2;
 
 /* Functions for part 2 */
+static force_inline void p2_count_accessible(struct part_context *ctx, size_t rows, size_t cols, size_t stride);
 
-void *p2_solve(void *arg) {
+internal void *p2_solve(void *arg) {
 
     struct part_context *ctx = arg;
 
     /* IO and synchronization */
-    string_t *input = ctx->common->input;
     size_t thread_count = ctx->common->thread_count;
     size_t thread_idx   = ctx->thread_idx;
 
-    UNUSED(p2);
-    UNUSED(input);
+    if (thread_idx == 0) {
+        p2_setup(ctx);
+    }
+
+    sync_all(ctx);
+
+    if (p2.rows == GRID_ROWS && p2.cols == GRID_COLS && p2.stride == GRID_COLS + 1) {
+        p2_count_accessible(ctx, GRID_ROWS, GRID_COLS, GRID_COLS + 1);
+    } else {
+        p2_count_accessible(ctx, p2.rows, p2.cols, p2.stride);
+    }
+
+    sync_all(ctx);
 
-    p2_setup(ctx);
+    part_phase(ctx, PHASE_FINALIZE);
 
     if (thread_idx == thread_count - 1) {
-        string_builder_t sb = sb_from_u64(p2.accessible_rolls, ctx->common->arena);
+        string_builder_t sb = sb_from_u64(part_reduce_sum(ctx), ctx->common->arena);
         ctx->common->output = sb_build(&sb);
     }
 
     return NULL;
 }
 
-static inline u8 p2_count_neighbors(size_t x, size_t y) {
+static force_inline u8 p2_count_neighbors(size_t x, size_t y, size_t rows, size_t cols) {
 
     u8 result = 0;
 
     for (i8 dx = -1; dx <= 1; ++dx) {
         for (i8 dy = -1; dy <= 1; ++dy) {
-            i16 check_x = x + dx;
-            i16 check_y = y + dy;
+            i64 check_x = (i64)x + dx;
+            i64 check_y = (i64)y + dy;
 
             if ((dx != 0 || dy != 0) 
-                    && (check_x >= 0 && check_x < GRID_COLS)
-                    && (check_y >= 0 && check_y < GRID_ROWS)
-                    && (p2.grid[check_y][check_x] == PAPER_ROLL)) {
+                    && (check_x >= 0 && check_x < (i64)cols)
+                    && (check_y >= 0 && check_y < (i64)rows)
+                    && (p2.grid[check_y * cols + check_x] == PAPER_ROLL)) {
                 ++result;
             }
         }
@@ -60,45 +78,70 @@ static inline u8 p2_count_neighbors(size_t x, size_t y) {
 
 }
 
+/* Sizes the grid from the shape of the input */
 static inline void p2_setup(struct part_context *ctx) {
 
+    const input_shape_t *shape = ctx->common->shape;
+    assert(shape->uniform && "Every row must have the same length");
+
+    p2.rows = shape->section_lines[0];
+    p2.cols = shape->line_length;
+    p2.stride = shape->line_length + shape->line_ending_length;
+
+    if (p2.rows * p2.cols <= sizeof (p2.grid_storage)) {
+        p2.grid = p2.grid_storage;
+    } else {
+        p2.grid = allocator_alloc(ctx->common->arena, p2.rows * p2.cols);
+    }
+}
+
+static force_inline void p2_count_accessible(struct part_context *ctx, size_t rows, size_t cols, size_t stride) {
+
     string_t *input = ctx->common->input;
 
     size_t start_row;
     size_t end_row;
-    split_by_thread(ctx, GRID_ROWS, &start_row, &end_row);
+    split_by_thread(ctx, rows, &start_row, &end_row);
 
     for (size_t y = start_row; y < end_row; ++y) {
 
-        for (size_t x = 0; x < GRID_COLS; ++x) {
+        for (size_t x = 0; x < cols; ++x) {
 
-            size_t char_idx = (GRID_COLS + 1) * y + x;
+            size_t char_idx = stride * y + x;
 
             switch (input->chars[char_idx]){
             case '@':
-                p2.grid[y][x] = PAPER_ROLL;
+                p2.grid[y * cols + x] = PAPER_ROLL;
                 break;
             case '.': 
             default:
-                p2.grid[y][x] = EMPTY;
+                p2.grid[y * cols + x] = EMPTY;
                 break;
             }
         
         }
     }
 
+    /* Neighbors may be in rows parsed by other threads */
+    sync_all(ctx);
+
+    part_phase(ctx, PHASE_COMPUTE);
+
+    u64 total_accessible = 0;
     u32 locally_accessible;
     do {
         locally_accessible = 0;
         for (size_t y = start_row; y < end_row; ++y) {
-            for (size_t x = 0; x < GRID_COLS; ++x) {
-                if ((p2.grid[y][x]) && p2_count_neighbors(x, y) < 4) {
+            for (size_t x = 0; x < cols; ++x) {
+                if ((p2.grid[y * cols + x]) && p2_count_neighbors(x, y, rows, cols) < 4) {
                     ++locally_accessible;
-                    p2.grid[y][x] = EMPTY;
+                    p2.grid[y * cols + x] = EMPTY;
                 }
             }
         }
 
-        atomic_fetch_add(&p2.accessible_rolls, locally_accessible);
+        total_accessible += locally_accessible;
     } while (locally_accessible > 0);
+
+    part_reduce_store(ctx, total_accessible);
 }
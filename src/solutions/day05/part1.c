@@ -4,15 +4,19 @@
 #define PART_1_IMPL
 
 #define P1_THREADS 1
+#define P1_BARRIER BARRIER_SPIN
 
+/* Fit the puzzle inputs, larger inputs are allocated from the arena */
 #define MAX_RANGE_COUNT 200
 #define MAX_ID_COUNT 2000
 
 /* Shared data between threads */
 struct p1_data {
-    range_inclusive_t ranges[MAX_RANGE_COUNT];
+    range_inclusive_t range_storage[MAX_RANGE_COUNT];
+    u64 id_storage[MAX_ID_COUNT];
+    range_inclusive_t *ranges;
     size_t range_count;
-    u64 ids[MAX_ID_COUNT];
+    u64 *ids;
     size_t id_count;
 };
 
@@ -21,7 +25,7 @@ static p1_data p1;
 /* Functions for part 1 */
 
 
-void *p1_solve(void *arg) {
+internal void *p1_solve(void *arg) {
 
     struct part_context *ctx = arg;
 
@@ -33,6 +37,8 @@ void *p1_solve(void *arg) {
         p1_setup(ctx);
     }
 
+    part_phase(ctx, PHASE_COMPUTE);
+
     parallel_partial_sort(ctx, p1.ranges, p1.range_count);
 
     sync_all(ctx);
@@ -69,6 +75,8 @@ void *p1_solve(void *arg) {
         if (is_fresh) ++result;
     }
 
+    part_phase(ctx, PHASE_FINALIZE);
+
     if (thread_idx == thread_count - 1) {
         string_builder_t sb = sb_from_u64(result, ctx->common->arena);
         ctx->common->output = sb_build(&sb);
@@ -82,6 +90,18 @@ static inline void p1_setup(struct part_context *ctx) {
     const string_t *input = ctx->common->input;
     string_t to_parse = *input;
 
+    /* The ranges and the ids are the first two sections of the input */
+    const input_shape_t *shape = ctx->common->shape;
+    size_t max_ranges = shape->section_lines[0];
+    size_t max_ids    = shape->section_lines[1];
+
+    p1.ranges = max_ranges <= MAX_RANGE_COUNT
+        ? p1.range_storage
+        : allocator_alloc(ctx->common->arena, max_ranges * sizeof (range_inclusive_t));
+    p1.ids = max_ids <= MAX_ID_COUNT
+        ? p1.id_storage
+        : allocator_alloc(ctx->common->arena, max_ids * sizeof (u64));
+
     /* Parse ranges */
     while (to_parse.chars[0] != '\n') {
         range_inclusive_t range;
@@ -3,10 +3,12 @@
 #define PART_2_IMPL
 
 #define P2_THREADS 1
+#define P2_BARRIER BARRIER_SPIN
 
 /* Shared data between threads */
 struct p2_data {
-    range_inclusive_t ranges[MAX_RANGE_COUNT];
+    range_inclusive_t range_storage[MAX_RANGE_COUNT];
+    range_inclusive_t *ranges;
     size_t range_count;
 };
 
@@ -14,7 +16,7 @@ static p2_data p2;
 
 /* Functions for part 2 */
 
-void *p2_solve(void *arg) {
+internal void *p2_solve(void *arg) {
     struct part_context *ctx = arg;
 
     /* IO and synchronization */
@@ -25,6 +27,8 @@ void *p2_solve(void *arg) {
         p2_setup(ctx);
     }
 
+    part_phase(ctx, PHASE_COMPUTE);
+
     parallel_partial_sort(ctx, p2.ranges, p2.range_count);
 
     sync_all(ctx);
@@ -49,6 +53,8 @@ void *p2_solve(void *arg) {
         result += length;
     }
 
+    part_phase(ctx, PHASE_FINALIZE);
+
     if (thread_idx == thread_count - 1) {
         string_builder_t sb = sb_from_u64(result, ctx->common->arena);
         ctx->common->output = sb_build(&sb);
@@ -62,6 +68,11 @@ static inline void p2_setup(struct part_context *ctx) {
     const string_t *input = ctx->common->input;
     string_t to_parse = *input;
 
+    size_t max_ranges = ctx->common->shape->section_lines[0];
+    p2.ranges = max_ranges <= MAX_RANGE_COUNT
+        ? p2.range_storage
+        : allocator_alloc(ctx->common->arena, max_ranges * sizeof (range_inclusive_t));
+
     /* Parse ranges */
     while (to_parse.chars[0] != '\n') {
         range_inclusive_t range;
@@ -3,6 +3,7 @@
 #define PART_1_IMPL
 
 #define P1_THREADS 1
+#define P1_BARRIER BARRIER_SPIN
 #define MAX_STACKS 1000
 #define MAX_LINES 5
 
@@ -13,18 +14,23 @@ enum __attribute__((packed)) operators {
 
 /* Shared data between threads */
 struct p1_data {
-    u64 values[MAX_STACKS][MAX_LINES];
+    u64 value_storage[MAX_STACKS * MAX_LINES];
+    enum operators op_storage[MAX_STACKS];
+    /* Point to the storage above, or to the arena for bigger inputs */
+    u64 *values;
     /* Single operator per stack */
-    enum operators ops[MAX_STACKS];
-    u16 stack_count;
-    u8 line_count;
+    enum operators *ops;
+    /* Values of a stack are contiguous, line_capacity apart from the next stack */
+    size_t line_capacity;
+    size_t stack_count;
+    size_t line_count;
 };
 
 static p1_data p1;
 
 /* Functions for part 1 */
 
-void *p1_solve(void *arg) {
+internal void *p1_solve(void *arg) {
 
     struct part_context *ctx = arg;
 
@@ -43,6 +49,8 @@ void *p1_solve(void *arg) {
 
     sync_all(ctx);
 
+    part_phase(ctx, PHASE_COMPUTE);
+
     u64 total = 0;
     for (size_t i = 0; i < p1.stack_count; ++i) {
         size_t j = p1.line_count;
@@ -63,10 +71,10 @@ void *p1_solve(void *arg) {
             size_t row = j - 1;
             switch (operator) {
             case ADD:
-                result += p1.values[i][row];
+                result += p1.values[i * p1.line_capacity + row];
                 break;
             case MUL:
-                result *= p1.values[i][row];
+                result *= p1.values[i * p1.line_capacity + row];
                 break;
             }
             --j;
@@ -75,6 +83,8 @@ void *p1_solve(void *arg) {
         total += result;
     }
 
+    part_phase(ctx, PHASE_FINALIZE);
+
     if (thread_idx == thread_count - 1) {
         string_builder_t sb = sb_from_u64(total, ctx->common->arena);
         ctx->common->output = sb_build(&sb);
@@ -89,18 +99,34 @@ static inline void p1_setup(struct part_context *ctx) {
 
     string_t to_parse = *input;
 
+    /* Numbers are at least one digit and one separator wide, and every line but the
+     * operator one holds a value of each stack */
+    const input_shape_t *shape = ctx->common->shape;
+    size_t max_stacks = (shape->max_line_length + 1) / 2;
+    size_t max_lines  = shape->line_count;
+
+    bool fits = max_stacks <= MAX_STACKS && max_lines <= MAX_LINES;
+    p1.line_capacity = fits ? MAX_LINES : max_lines;
+    p1.values = fits
+        ? p1.value_storage
+        : allocator_alloc(ctx->common->arena, max_stacks * max_lines * sizeof (u64));
+    p1.ops = max_stacks <= MAX_STACKS
+        ? p1.op_storage
+        : allocator_alloc(ctx->common->arena, max_stacks * sizeof (enum operators));
+
     size_t stack_count = 0;
     size_t line_count = 0;
-    while (to_parse.count > 0) {
+    /* Malformed lines stop at the capacity instead of writing past it */
+    while (to_parse.count > 0 && line_count < max_lines) {
         stack_count = 0;
-        while (to_parse.chars[0] == MUL || to_parse.chars[0] == ADD) {
+        while ((to_parse.chars[0] == MUL || to_parse.chars[0] == ADD) && stack_count < max_stacks) {
             p1.ops[stack_count++] = to_parse.chars[0];       
             skip_n_chars(to_parse, &to_parse, 1);
             skip_whitespace(to_parse, &to_parse);
 
         }
-        while (to_parse.count > 0 && to_parse.chars[0] != '\n') {
-            p1.values[stack_count++][line_count] = parse_u64(to_parse, &to_parse);       
+        while (to_parse.count > 0 && to_parse.chars[0] != '\n' && stack_count < max_stacks) {
+            p1.values[stack_count++ * p1.line_capacity + line_count] = parse_u64(to_parse, &to_parse);       
             skip_all_of(to_parse, &to_parse, " ", 1);
         }
         ++line_count;
@@ -2,6 +2,7 @@
 #define PART_1_IMPL
 
 #define P1_THREADS 1
+#define P1_BARRIER BARRIER_SPIN
 
 /* Shared data between threads */
 struct p1_data {
@@ -11,7 +12,7 @@ static p1_data p1;
 
 /* Functions for part 1 */
 
-void *p1_solve(void *arg) {
+internal void *p1_solve(void *arg) {
 
     struct part_context *ctx = arg;
 
@@ -29,6 +30,10 @@ void *p1_solve(void *arg) {
 
     sync_all(ctx);
 
+    part_phase(ctx, PHASE_COMPUTE);
+
+    part_phase(ctx, PHASE_FINALIZE);
+
     if (thread_idx == thread_count - 1) {
         string_builder_t sb;
         UNUSED(sb);
@@ -2,6 +2,7 @@
 #define PART_2_IMPL
 
 #define P2_THREADS 1
+#define P2_BARRIER BARRIER_SPIN
 
 /* Shared data between threads */
 struct p2_data {
@@ -11,7 +12,7 @@ static p2_data p2;
 
 /* Functions for part 2 */
 
-void *p2_solve(void *arg) {
+internal void *p2_solve(void *arg) {
 
     struct part_context *ctx = arg;
 
@@ -29,6 +30,10 @@ void *p2_solve(void *arg) {
 
     sync_all(ctx);
 
+    part_phase(ctx, PHASE_COMPUTE);
+
+    part_phase(ctx, PHASE_FINALIZE);
+
     if (thread_idx == thread_count - 1) {
         string_builder_t sb;
         UNUSED(sb);
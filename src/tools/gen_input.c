@@ -0,0 +1,271 @@
+/*
+ * Generates valid inputs of a day at any scale, to measure how the solutions scale past
+ * the size of the puzzle inputs.
+ *
+ * Usage: gen_input day [-s scale] [-r seed] [-k skew] [-d density]
+ *     day        - Day to generate the input of (1 to 6).
+ *     -s scale   - Size relative to the puzzle input, 10 is ten times as many lines,
+ *                  ranges or cells (default 1).
+ *     -r seed    - Seed of the generator, the same seed gives the same input (default 1).
+ *     -k skew    - Exponent applied to the uniform draws of the lengths of the ranges
+ *                  (days 2 and 5) or of the values (other days): 1 is uniform, above 1
+ *                  most are short or small with a long tail, below 1 most are long.
+ *     -d density - Fraction of the cells of the grid with a roll of paper (day 4,
+ *                  default 0.67, like the puzzle input).
+ *
+ * The input is written to stdout. The runner only holds RUNNER_FILE_CAP bytes of input,
+ * so large scales need the days built with a larger -DRUNNER_FILE_CAP.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../utils/macros.h"
+#include "../utils/typedefs.h"
+
+typedef struct {
+    double scale;
+    double skew;
+    double density;
+    u64    seed;
+} gen_options_t;
+
+typedef struct {
+    u64 start;
+    u64 end;
+} gen_range_t;
+
+/* splitmix64 */
+internal u64 gen_random(u64 *state) {
+    u64 z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/* Uniform in [0, 1) */
+internal double gen_uniform(u64 *state) {
+    return (double)(gen_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* In [low, high], skewed toward low when skew > 1 */
+internal u64 gen_skewed(u64 *state, u64 low, u64 high, double skew) {
+    double u = pow(gen_uniform(state), skew);
+    return low + (u64)(u * (double)(high - low));
+}
+
+/* Uniform in [low, high] */
+internal u64 gen_between(u64 *state, u64 low, u64 high) {
+    return low + gen_random(state) % (high - low + 1);
+}
+
+/* Count of the puzzle input times the scale, at least one */
+internal size_t gen_count(size_t puzzle_count, double scale) {
+    double count = (double)puzzle_count * scale + 0.5;
+    return count < 1.0 ? 1 : (size_t)count;
+}
+
+internal int gen_compare_ranges(const void *a, const void *b) {
+    u64 x = ((const gen_range_t *)a)->start;
+    u64 y = ((const gen_range_t *)b)->start;
+    return (x > y) - (x < y);
+}
+
+/* Rotations of the dial, "L68" or "R48" */
+internal void gen_day01(const gen_options_t *options, u64 *state) {
+
+    size_t lines = gen_count(4000, options->scale);
+
+    for (size_t i = 0; i < lines; ++i) {
+        char direction = gen_random(state) & 1 ? 'R' : 'L';
+        printf("%c%lu\n", direction, gen_skewed(state, 1, 999, options->skew));
+    }
+}
+
+/*
+ * Ranges of product ids on a single line, "11-22,95-115,...".
+ *
+ * The ids have 3 to 10 digits like the puzzle input, and the ranges do not overlap: each
+ * one is cut short before the start of the next.
+ */
+internal void gen_day02(const gen_options_t *options, u64 *state) {
+
+    size_t count = gen_count(35, options->scale);
+    gen_range_t *ranges = malloc(count * sizeof (gen_range_t));
+
+    for (size_t i = 0; i < count; ++i) {
+        u32 digits = gen_between(state, 3, 10);
+        u64 low    = 1;
+        for (u32 d = 1; d < digits; ++d) low *= 10;
+
+        ranges[i].start = gen_between(state, low, 10 * low - 1);
+        ranges[i].end   = ranges[i].start + gen_skewed(state, 0, 20000, options->skew);
+    }
+
+    qsort(ranges, count, sizeof (gen_range_t), gen_compare_ranges);
+
+    /* Drops repeated starts, then cuts the overlaps */
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (kept > 0 && ranges[i].start == ranges[kept - 1].start) continue;
+        ranges[kept++] = ranges[i];
+    }
+    for (size_t i = 0; i + 1 < kept; ++i) {
+        if (ranges[i].end >= ranges[i + 1].start) ranges[i].end = ranges[i + 1].start - 1;
+    }
+
+    /* The puzzle input is not sorted either */
+    for (size_t i = kept - 1; i > 0; --i) {
+        size_t j = gen_random(state) % (i + 1);
+        gen_range_t temp = ranges[i];
+        ranges[i] = ranges[j];
+        ranges[j] = temp;
+    }
+
+    for (size_t i = 0; i < kept; ++i) {
+        printf("%s%lu-%lu", i > 0 ? "," : "", ranges[i].start, ranges[i].end);
+    }
+    printf("\n");
+
+    free(ranges);
+}
+
+/* Banks of 100 batteries, one joltage digit (1-9) per battery */
+internal void gen_day03(const gen_options_t *options, u64 *state) {
+
+    size_t lines = gen_count(200, options->scale);
+    char line[101];
+    line[100] = '\0';
+
+    for (size_t i = 0; i < lines; ++i) {
+        for (size_t j = 0; j < 100; ++j) {
+            line[j] = '0' + gen_skewed(state, 1, 9, options->skew);
+        }
+        puts(line);
+    }
+}
+
+/* A square grid of '@' (paper) and '.', the cell count grows with the scale */
+internal void gen_day04(const gen_options_t *options, u64 *state) {
+
+    size_t side = gen_count(135, sqrt(options->scale));
+    char *line = malloc(side + 1);
+    line[side] = '\0';
+
+    for (size_t row = 0; row < side; ++row) {
+        for (size_t col = 0; col < side; ++col) {
+            line[col] = gen_uniform(state) < options->density ? '@' : '.';
+        }
+        puts(line);
+    }
+
+    free(line);
+}
+
+/*
+ * Fresh ingredient id ranges, a blank line, then the available ids.
+ *
+ * Like the puzzle input, the ids have 13 to 15 digits and the ranges overlap.
+ */
+internal void gen_day05(const gen_options_t *options, u64 *state) {
+
+    static const u64 max_id = 999999999999999ULL;
+
+    size_t range_count = gen_count(190, options->scale);
+    size_t id_count    = gen_count(1000, options->scale);
+
+    for (size_t i = 0; i < range_count; ++i) {
+        u64 length = gen_skewed(state, 0, 1000000000000ULL, options->skew);
+        u64 start  = gen_between(state, 1000000000000ULL, max_id - length);
+        printf("%lu-%lu\n", start, start + length);
+    }
+
+    printf("\n");
+
+    for (size_t i = 0; i < id_count; ++i) {
+        printf("%lu\n", gen_between(state, 1000000000000ULL, max_id));
+    }
+}
+
+/* Four lines of numbers and a line of operators, one problem per column */
+internal void gen_day06(const gen_options_t *options, u64 *state) {
+
+    size_t columns = gen_count(1000, options->scale);
+
+    for (size_t line = 0; line < 4; ++line) {
+        for (size_t col = 0; col < columns; ++col) {
+            printf("%s%lu", col > 0 ? " " : "", gen_skewed(state, 1, 9999, options->skew));
+        }
+        printf("\n");
+    }
+
+    for (size_t col = 0; col < columns; ++col) {
+        printf("%s%c", col > 0 ? " " : "", gen_random(state) & 1 ? '*' : '+');
+    }
+    printf("\n");
+}
+
+global_var void (*generators[])(const gen_options_t *, u64 *) = {
+    gen_day01, gen_day02, gen_day03, gen_day04, gen_day05, gen_day06,
+};
+
+#define GENERATOR_COUNT (sizeof (generators) / sizeof (generators[0]))
+
+internal void usage(const char *program) {
+    fprintf(stderr, "Usage: %s day [-s scale] [-r seed] [-k skew] [-d density]\n", program);
+}
+
+int main(int argc, char **argv) {
+
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    unsigned long day = strtoul(argv[1], NULL, 10);
+    if (day < 1 || day > GENERATOR_COUNT) {
+        fprintf(stderr, "There is no generator for day %s (1 to %zu)\n", argv[1], GENERATOR_COUNT);
+        return 1;
+    }
+
+    gen_options_t options = {
+        .scale   = 1.0,
+        .skew    = 1.0,
+        .density = 0.67,
+        .seed    = 1,
+    };
+
+    for (int i = 2; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+
+        const char *value = argv[i + 1];
+        if      (strcmp(argv[i], "-s") == 0) options.scale   = strtod(value, NULL);
+        else if (strcmp(argv[i], "-r") == 0) options.seed    = strtoull(value, NULL, 10);
+        else if (strcmp(argv[i], "-k") == 0) options.skew    = strtod(value, NULL);
+        else if (strcmp(argv[i], "-d") == 0) options.density = strtod(value, NULL);
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.scale <= 0.0 || options.skew <= 0.0 || options.density < 0.0 || options.density > 1.0) {
+        fprintf(stderr, "The scale and skew must be positive and the density in [0, 1]\n");
+        return 1;
+    }
+
+    /* The inputs reach hundreds of MB, write them in large blocks */
+    static char buffer[1 << 20];
+    setvbuf(stdout, buffer, _IOFBF, sizeof (buffer));
+
+    u64 state = options.seed;
+    generators[day - 1](&options, &state);
+
+    return fflush(stdout) == 0 ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+/*
+ * Measures how long a day takes from exec to its answers, process startup included.
+ *
+ * The benchmarks of the runner only time the solve functions, which leaves out
+ * everything a user waits for before them: exec and the dynamic loader, loading the
+ * locale, mapping the arenas and faulting in the input buffer. This runs the program
+ * with its stdout on a pipe and timestamps the answer lines as they arrive.
+ *
+ * Usage: startup_latency [-n runs] program...
+ *     -n runs - How many times to run each program (default 50).
+ *
+ * The programs run in the current directory, so they find inputs/ as usual. For each
+ * one, the min/median/max over the runs of the time until the first answer, until the
+ * answers of every part and until the program exits (benchmarks included) are
+ * reported. With more than one program, the medians are compared against the first.
+ */
+
+#include <locale.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../utils/macros.h"
+#include "../utils/typedefs.h"
+
+#define DEFAULT_RUNS 50
+
+/* Printed by the runner right before the answer of each part */
+#define ANSWER_HEADER "Solution to part "
+
+enum startup_event {
+    EVENT_FIRST_ANSWER = 0,
+    EVENT_ALL_ANSWERS,
+    EVENT_EXIT,
+    EVENT_COUNT,
+};
+
+global_var const char *event_names[EVENT_COUNT] = {
+    [EVENT_FIRST_ANSWER] = "first answer",
+    [EVENT_ALL_ANSWERS]  = "all answers",
+    [EVENT_EXIT]         = "exit",
+};
+
+typedef struct {
+    const char *program;
+    /* Time of each event in each run, times[event * runs + run] */
+    u64        *times;
+    u64         medians[EVENT_COUNT];
+} program_stats_t;
+
+internal u64 now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+internal int compare_u64(const void *a, const void *b) {
+    u64 x = *(const u64 *)a;
+    u64 y = *(const u64 *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Runs the program once, reading its stdout until it exits.
+ *
+ * times - Receives the time of each event since the fork, in ns.
+ *
+ * Returns:
+ *     false if the program could not be run, failed or printed no answer.
+ */
+internal bool run_once(const char *program, u64 times[EVENT_COUNT]) {
+
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) return false;
+
+    u64 start = now_ns();
+
+    pid_t pid = fork();
+    if (pid < 0) return false;
+
+    if (pid == 0) {
+        dup2(pipe_fds[1], STDOUT_FILENO);
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        execl(program, program, (char *)NULL);
+        _exit(127);
+    }
+
+    close(pipe_fds[1]);
+
+    /* Only the current line is kept, the answers are short */
+    char   line[4096];
+    size_t line_length   = 0;
+    bool   answer_next   = false;
+    size_t answers       = 0;
+    u64    first_answer  = 0;
+    u64    last_answer   = 0;
+
+    char    buffer[4096];
+    ssize_t bytes;
+    while ((bytes = read(pipe_fds[0], buffer, sizeof (buffer))) > 0) {
+        u64 arrival = now_ns() - start;
+
+        for (ssize_t i = 0; i < bytes; ++i) {
+            if (buffer[i] != '\n') {
+                if (line_length < sizeof (line) - 1) line[line_length++] = buffer[i];
+                continue;
+            }
+            line[line_length] = '\0';
+
+            if (answer_next) {
+                if (answers == 0) first_answer = arrival;
+                last_answer = arrival;
+                ++answers;
+            }
+            answer_next = strncmp(line, ANSWER_HEADER, strlen(ANSWER_HEADER)) == 0;
+            line_length = 0;
+        }
+    }
+
+    close(pipe_fds[0]);
+
+    int status;
+    waitpid(pid, &status, 0);
+
+    times[EVENT_FIRST_ANSWER] = first_answer;
+    times[EVENT_ALL_ANSWERS]  = last_answer;
+    times[EVENT_EXIT]         = now_ns() - start;
+
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 && answers > 0;
+}
+
+internal bool measure(program_stats_t *stats, size_t runs) {
+
+    stats->times = malloc(EVENT_COUNT * runs * sizeof (u64));
+    if (!stats->times) return false;
+
+    for (size_t run = 0; run < runs; ++run) {
+        u64 times[EVENT_COUNT];
+        if (!run_once(stats->program, times)) {
+            fprintf(stderr, "%s failed or printed no answer\n", stats->program);
+            return false;
+        }
+
+        for (size_t event = 0; event < EVENT_COUNT; ++event) {
+            stats->times[event * runs + run] = times[event];
+        }
+    }
+
+    printf("%s (%zu runs, ns):\n", stats->program, runs);
+    printf("  %-13s %12s %12s %12s\n", "event", "min", "median", "max");
+
+    for (size_t event = 0; event < EVENT_COUNT; ++event) {
+        u64 *times = &stats->times[event * runs];
+        qsort(times, runs, sizeof (u64), compare_u64);
+
+        stats->medians[event] = times[runs / 2];
+        printf("  %-13s %'12lu %'12lu %'12lu\n", event_names[event], times[0], times[runs / 2], times[runs - 1]);
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv) {
+
+    setlocale(LC_NUMERIC, "pt_BR.UTF-8");
+
+    /* A program that exits before we are done reading must not kill us */
+    signal(SIGPIPE, SIG_IGN);
+
+    size_t runs = DEFAULT_RUNS;
+    int    arg  = 1;
+    if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+        runs = strtoul(argv[2], NULL, 10);
+        arg  = 3;
+    }
+
+    if (arg >= argc || runs == 0) {
+        fprintf(stderr, "Usage: %s [-n runs] program...\n", argv[0]);
+        return 1;
+    }
+
+    size_t program_count = argc - arg;
+    program_stats_t *stats = calloc(program_count, sizeof (program_stats_t));
+
+    for (size_t i = 0; i < program_count; ++i) {
+        stats[i].program = argv[arg + i];
+        if (!measure(&stats[i], runs)) return 1;
+    }
+
+    if (program_count > 1) {
+        printf("Median relative to %s:\n", stats[0].program);
+        for (size_t i = 1; i < program_count; ++i) {
+            printf("  %s:", stats[i].program);
+            for (size_t event = 0; event < EVENT_COUNT; ++event) {
+                double ratio = (double)stats[i].medians[event] / (double)(max(stats[0].medians[event], 1));
+                printf("  %s %.2fx", event_names[event], ratio);
+            }
+            printf("\n");
+        }
+    }
+
+    return 0;
+}
@@ -33,19 +33,19 @@ typedef struct {
     void                  *alloc_ctx;
 } allocator_t;
 
-void *allocator_alloc(const allocator_t *allocator, size_t size) {
+internal void *allocator_alloc(const allocator_t *allocator, size_t size) {
     return allocator->interface->alloc(allocator->alloc_ctx, size);
 }
 
-void *allocator_realloc(const allocator_t *allocator, void *ptr, const size_t old_size, const size_t new_size) {
+internal void *allocator_realloc(const allocator_t *allocator, void *ptr, const size_t old_size, const size_t new_size) {
     return allocator->interface->realloc(allocator->alloc_ctx, ptr, old_size, new_size);
 }
 
-void allocator_free(const allocator_t *allocator, void *ptr, const size_t size) {
+internal void allocator_free(const allocator_t *allocator, void *ptr, const size_t size) {
     return allocator->interface->free(allocator->alloc_ctx, ptr, size);
 }
 
-void allocator_free_all(const allocator_t *allocator) {
+internal void allocator_free_all(const allocator_t *allocator) {
     return allocator->interface->free_all(allocator->alloc_ctx);
 }
 
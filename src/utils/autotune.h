@@ -0,0 +1,189 @@
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+/*
+ * Thread count autotuning.
+ *
+ * Each part is timed on the real input with a few candidate thread counts and the
+ * fastest one is stored in a small tuning file per day (TUNING_FOLDER/day_XX.txt).
+ * Later runs load the file, so changing the input or the machine only requires
+ * running the program with --autotune again instead of editing P1_THREADS/P2_THREADS.
+ *
+ * Candidates whose answer differs from the single-threaded answer are rejected, so
+ * parts that are not safe to run with more threads simply stay single-threaded.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "macros.h"
+#include "typedefs.h"
+#include "string_utils.h"
+
+#ifndef TUNING_FOLDER
+#define TUNING_FOLDER "build/tuning/"
+#endif /* ifndef TUNING_FOLDER */
+
+/* Runs per candidate, the median is used to compare them */
+#ifndef AUTOTUNE_RUNS
+#define AUTOTUNE_RUNS 9
+#endif /* ifndef AUTOTUNE_RUNS */
+
+/* Longest answer that can be compared between candidates */
+#define AUTOTUNE_MAX_OUTPUT 256
+
+typedef struct {
+    size_t p1_threads;
+    size_t p2_threads;
+    /* Size of the input that was used for tuning */
+    size_t input_size;
+} tuning_t;
+
+/*
+ * Runs a part once with thread_count threads.
+ *
+ * arg    - The argument given to autotune_part.
+ * output - Where to store the answer (only needs to be valid until the next call).
+ *
+ * Returns:
+ *     How long the part took, in nanoseconds.
+ */
+typedef u64 (*autotune_run_fn)(void *arg, size_t thread_count, string_t *output);
+
+/*
+ * Times the part for every candidate thread count (powers of 2 up to max_threads, limited
+ * by the number of online CPUs) and prints the results.
+ *
+ * Returns:
+ *     The fastest thread count that produced the same answer as a single thread.
+ */
+internal size_t autotune_part(const char *label, autotune_run_fn run, void *arg, size_t max_threads);
+
+/* Loads the tuning of the given day, returns false if there is no (valid) tuning file */
+internal bool tuning_load(u32 day, tuning_t *tuning);
+
+/* Stores the tuning of the given day, returns false if the file could not be written */
+internal bool tuning_save(u32 day, const tuning_t *tuning);
+
+internal inline void autotune_sort(u64 *values, size_t count) {
+    for (size_t i = 1; i < count; ++i) {
+        u64 current = values[i];
+        size_t j = i;
+        while (j > 0 && values[j - 1] > current) {
+            values[j] = values[j - 1];
+            --j;
+        }
+        values[j] = current;
+    }
+}
+
+internal size_t autotune_part(const char *label, autotune_run_fn run, void *arg, size_t max_threads) {
+
+    long online_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t cpu_limit = online_cpus > 0 ? (size_t)online_cpus : 1;
+
+    char reference[AUTOTUNE_MAX_OUTPUT];
+    size_t reference_count = 0;
+
+    size_t best_threads = 1;
+    u64    best_time    = UINT64_MAX;
+
+    printf("%s:\n", label);
+    printf("  %8s %16s\n", "threads", "median (ns)");
+
+    for (size_t threads = 1; threads <= max_threads && threads <= cpu_limit; threads *= 2) {
+
+        u64 times[AUTOTUNE_RUNS];
+        bool same_answer = true;
+
+        for (size_t i = 0; i < AUTOTUNE_RUNS; ++i) {
+            string_t output;
+            times[i] = run(arg, threads, &output);
+
+            if (threads == 1 && i == 0) {
+                reference_count = min(output.count, AUTOTUNE_MAX_OUTPUT);
+                memcpy(reference, output.chars, reference_count);
+            } else {
+                same_answer &= output.count == reference_count
+                            && memcmp(output.chars, reference, reference_count) == 0;
+            }
+        }
+
+        autotune_sort(times, AUTOTUNE_RUNS);
+        u64 median = times[AUTOTUNE_RUNS / 2];
+
+        if (!same_answer) {
+            printf("  %8zu %'16lu (wrong answer, rejected)\n", threads, median);
+            continue;
+        }
+
+        printf("  %8zu %'16lu\n", threads, median);
+
+        if (median < best_time) {
+            best_time    = median;
+            best_threads = threads;
+        }
+    }
+
+    printf("  Picked %zu thread(s)\n", best_threads);
+
+    return best_threads;
+}
+
+internal inline void tuning_path(u32 day, char *path, size_t path_size) {
+    snprintf(path, path_size, TUNING_FOLDER"day_%02u.txt", day);
+}
+
+internal bool tuning_load(u32 day, tuning_t *tuning) {
+
+    char path[256];
+    tuning_path(day, path, sizeof (path));
+
+    FILE *file = fopen(path, "r");
+    if (!file) return false;
+
+    tuning_t loaded = {0};
+    char key[32];
+    size_t value;
+    bool valid = true;
+
+    while (fscanf(file, "%31s %zu", key, &value) == 2) {
+        if (strcmp(key, "p1_threads") == 0) {
+            loaded.p1_threads = value;
+        } else if (strcmp(key, "p2_threads") == 0) {
+            loaded.p2_threads = value;
+        } else if (strcmp(key, "input_size") == 0) {
+            loaded.input_size = value;
+        } else {
+            valid = false;
+        }
+    }
+
+    fclose(file);
+
+    if (!valid || loaded.p1_threads == 0 || loaded.p2_threads == 0) return false;
+
+    *tuning = loaded;
+    return true;
+}
+
+internal bool tuning_save(u32 day, const tuning_t *tuning) {
+
+    char path[256];
+    tuning_path(day, path, sizeof (path));
+
+    FILE *file = fopen(path, "w");
+    if (!file) return false;
+
+    fprintf(file, "p1_threads %zu\n", tuning->p1_threads);
+    fprintf(file, "p2_threads %zu\n", tuning->p2_threads);
+    fprintf(file, "input_size %zu\n", tuning->input_size);
+
+    fclose(file);
+    return true;
+}
+
+#endif /* ifndef AUTOTUNE_H */
@@ -0,0 +1,128 @@
+#ifndef BARRIER_H
+#define BARRIER_H
+
+/*
+ * Sense-reversing barrier that spins for a short while before sleeping on a futex.
+ *
+ * pthread_barrier_wait goes through a mutex and a condition variable, so every phase
+ * pays at least one round trip through the kernel. Phases of the solutions are often
+ * only a few microseconds long, so here the threads first spin on the sense of the
+ * barrier and only fall back to the futex if the other threads take too long.
+ *
+ * The sense is a generation counter instead of a single bit, which also makes it a
+ * valid futex word: a thread waits until the generation it saw on arrival changes.
+ */
+
+#include <immintrin.h>
+#include <limits.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "futex.h"
+#include "typedefs.h"
+
+/* How many times to poll the sense before sleeping on the futex */
+#ifndef BARRIER_SPIN_COUNT
+#define BARRIER_SPIN_COUNT 4096
+#endif /* ifndef BARRIER_SPIN_COUNT */
+
+enum barrier_type {
+    /* Spin, then futex (spin_barrier_t) */
+    BARRIER_SPIN = 0,
+    /* pthread_barrier_t */
+    BARRIER_PTHREAD,
+    BARRIER_TYPE_COUNT
+};
+
+global_var const char *barrier_type_names[BARRIER_TYPE_COUNT] = {
+    [BARRIER_SPIN]    = "spin",
+    [BARRIER_PTHREAD] = "pthread",
+};
+
+typedef struct {
+    /* Threads that arrived in the current generation */
+    alignas(64) atomic_uint_least32_t arrived;
+    /* Bumped by the last thread to arrive, releasing the others */
+    alignas(64) atomic_uint_least32_t generation;
+    /* Threads sleeping (or about to sleep) on generation */
+    atomic_uint_least32_t             sleepers;
+    u32                               thread_count;
+} spin_barrier_t;
+
+/* Prepares the barrier for thread_count threads, must not be called while threads are waiting on it */
+internal void spin_barrier_init(spin_barrier_t *barrier, u32 thread_count);
+
+/* Waits until thread_count threads called it */
+internal void spin_barrier_wait(spin_barrier_t *barrier);
+
+/* Parses a barrier name (see barrier_type_names), returns BARRIER_TYPE_COUNT if unknown */
+internal enum barrier_type barrier_type_from_cstr(const char *name);
+
+/* Barrier from the AOC_BARRIER environment variable, or default_type if not set (or invalid) */
+internal enum barrier_type barrier_type_from_env(enum barrier_type default_type);
+
+internal void spin_barrier_init(spin_barrier_t *barrier, u32 thread_count) {
+    atomic_init(&barrier->arrived, 0);
+    atomic_init(&barrier->generation, 0);
+    atomic_init(&barrier->sleepers, 0);
+    barrier->thread_count = thread_count;
+}
+
+internal void spin_barrier_wait(spin_barrier_t *barrier) {
+
+    u32 generation = atomic_load_explicit(&barrier->generation, memory_order_acquire);
+
+    if (atomic_fetch_add_explicit(&barrier->arrived, 1, memory_order_acq_rel) == barrier->thread_count - 1) {
+        /* Last one in: nobody can arrive for the next generation before it is published */
+        atomic_store_explicit(&barrier->arrived, 0, memory_order_relaxed);
+        atomic_store_explicit(&barrier->generation, generation + 1, memory_order_seq_cst);
+
+        if (atomic_load_explicit(&barrier->sleepers, memory_order_seq_cst) > 0) {
+            futex_wake(&barrier->generation, INT_MAX);
+        }
+        return;
+    }
+
+    for (u32 spin = 0; spin < BARRIER_SPIN_COUNT; ++spin) {
+        if (atomic_load_explicit(&barrier->generation, memory_order_acquire) != generation) return;
+        _mm_pause();
+    }
+
+    atomic_fetch_add_explicit(&barrier->sleepers, 1, memory_order_seq_cst);
+
+    /* Recheck after announcing that we are going to sleep, otherwise we could miss the wake up */
+    while (atomic_load_explicit(&barrier->generation, memory_order_seq_cst) == generation) {
+        futex_wait(&barrier->generation, generation);
+    }
+
+    atomic_fetch_sub_explicit(&barrier->sleepers, 1, memory_order_relaxed);
+}
+
+internal enum barrier_type barrier_type_from_cstr(const char *name) {
+
+    for (enum barrier_type type = 0; type < BARRIER_TYPE_COUNT; ++type) {
+        if (strcmp(name, barrier_type_names[type]) == 0) return type;
+    }
+
+    return BARRIER_TYPE_COUNT;
+}
+
+internal enum barrier_type barrier_type_from_env(enum barrier_type default_type) {
+
+    const char *name = getenv("AOC_BARRIER");
+    if (name == NULL) return default_type;
+
+    enum barrier_type type = barrier_type_from_cstr(name);
+    if (type == BARRIER_TYPE_COUNT) {
+        fprintf(stderr, "Unknown barrier '%s', using '%s'\n", name, barrier_type_names[default_type]);
+        return default_type;
+    }
+
+    return type;
+}
+
+#endif /* ifndef BARRIER_H */
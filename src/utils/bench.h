@@ -0,0 +1,259 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+/*
+ * Benchmark statistics.
+ *
+ * A benchmark first runs a few unmeasured warmup iterations (caches, branch predictors
+ * and parked worker threads), then measures at least min_runs iterations and keeps
+ * going until the mean is known precisely enough (the 95% confidence interval is within
+ * target_precision of it) or until max_runs or max_time_ns are reached:
+ *
+ *     bench_t bench;
+ *     bench_init(&bench, &config);
+ *
+ *     while (bench_next(&bench)) {
+ *         u64 start = timer_ticks();
+ *         ...
+ *         bench_record(&bench, timer_ticks_to_ns(timer_ticks_end() - start));
+ *     }
+ *
+ *     bench_stats_t stats = bench_stats(&bench);
+ *     bench_free(&bench);
+ *
+ * The percentiles are taken over every measured run. The mean, standard deviation and
+ * coefficient of variation skip the outliers (such as a run that was preempted), runs
+ * further than BENCH_OUTLIER_THRESHOLD scaled median absolute deviations (MAD) from the
+ * median, so one of them can not keep the benchmark from converging.
+ */
+
+#include <assert.h>
+#include <immintrin.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "typedefs.h"
+
+/* Modified z-score above which a run is an outlier (Iglewicz and Hoaglin) */
+#ifndef BENCH_OUTLIER_THRESHOLD
+#define BENCH_OUTLIER_THRESHOLD 3.5
+#endif /* ifndef BENCH_OUTLIER_THRESHOLD */
+
+/* Scales the MAD to the standard deviation of a normal distribution */
+#define BENCH_MAD_SCALE 1.4826
+
+typedef struct {
+    /* Unmeasured runs before the measured ones */
+    size_t warmup_runs;
+    /* Measured runs, the benchmark stops somewhere in between */
+    size_t min_runs;
+    size_t max_runs;
+    /* Stops once the measured runs took this long, even if the target was not reached */
+    u64    max_time_ns;
+    /* Half-width of the 95% confidence interval of the mean, relative to the mean */
+    double target_precision;
+} bench_config_t;
+
+#define BENCH_DEFAULT_CONFIG (bench_config_t) {  \
+        .warmup_runs      = 3,                    \
+        .min_runs         = 8,                    \
+        .max_runs         = 1000,                 \
+        .max_time_ns      = 500 * 1000 * 1000,    \
+        .target_precision = 0.01,                 \
+    }
+
+typedef struct {
+    bench_config_t config;
+
+    /* Time of each measured run, in the order they ran */
+    u64   *samples;
+    size_t count;
+    size_t warmup_done;
+    u64    total_time;
+
+    /* Sorted copy of the samples, used for the statistics */
+    u64   *sorted;
+    /* Measured runs at the next convergence check */
+    size_t next_check;
+} bench_t;
+
+typedef struct {
+    size_t runs;
+    size_t warmup_runs;
+    /* Runs left out of the mean, standard deviation and CV */
+    size_t outliers;
+
+    u64    min;
+    u64    median;
+    u64    p90;
+    u64    p99;
+    u64    max;
+    /* Median absolute deviation from the median */
+    u64    mad;
+
+    double mean;
+    double stddev;
+    /* Standard deviation relative to the mean */
+    double cv;
+    /* Half-width of the 95% confidence interval of the mean, relative to the mean */
+    double precision;
+    /* The precision target is met (otherwise max_runs or max_time_ns stopped the runs) */
+    bool   converged;
+} bench_stats_t;
+
+/* Allocates room for config->max_runs samples */
+internal void bench_init(bench_t *bench, const bench_config_t *config);
+
+internal void bench_free(bench_t *bench);
+
+/*
+ * Decides whether to run one more iteration.
+ *
+ * Returns:
+ *     false once the benchmark is done.
+ */
+internal bool bench_next(bench_t *bench);
+
+/*
+ * Records the time of the iteration that just ran.
+ *
+ * Returns:
+ *     true if it was measured, as sample bench->count - 1, false if it was a warmup run.
+ */
+internal bool bench_record(bench_t *bench, u64 time);
+
+/* Statistics of the measured runs so far */
+internal bench_stats_t bench_stats(bench_t *bench);
+
+/* Value at percentile p (0-100) of sorted values, using the nearest rank */
+internal inline u64 bench_percentile(const u64 *sorted, size_t count, u32 p) {
+    size_t idx = (count * p + 99) / 100;
+    return sorted[idx > 0 ? idx - 1 : 0];
+}
+
+/* Without libm, the solutions are not linked with it */
+internal inline double bench_sqrt(double x) {
+    return _mm_cvtsd_f64(_mm_sqrt_sd(_mm_setzero_pd(), _mm_set_sd(x)));
+}
+
+internal int bench_compare_u64(const void *a, const void *b) {
+    u64 x = *(const u64 *)a;
+    u64 y = *(const u64 *)b;
+    return (x > y) - (x < y);
+}
+
+internal void bench_init(bench_t *bench, const bench_config_t *config) {
+
+    assert(config->max_runs >= config->min_runs && config->max_runs > 0 && "Invalid run limits");
+
+    memset(bench, 0, sizeof (*bench));
+
+    bench->config     = *config;
+    bench->samples    = malloc(config->max_runs * sizeof (u64));
+    bench->sorted     = malloc(config->max_runs * sizeof (u64));
+    bench->next_check = config->min_runs;
+
+    assert(bench->samples && bench->sorted && "Could not allocate the benchmark samples");
+}
+
+internal void bench_free(bench_t *bench) {
+    free(bench->samples);
+    free(bench->sorted);
+    bench->samples = NULL;
+    bench->sorted  = NULL;
+}
+
+internal bench_stats_t bench_stats(bench_t *bench) {
+
+    bench_stats_t stats = {
+        .runs        = bench->count,
+        .warmup_runs = bench->warmup_done,
+    };
+
+    size_t count = bench->count;
+    if (count == 0) return stats;
+
+    u64 *sorted = bench->sorted;
+    memcpy(sorted, bench->samples, count * sizeof (u64));
+    qsort(sorted, count, sizeof (u64), bench_compare_u64);
+
+    stats.min    = sorted[0];
+    stats.max    = sorted[count - 1];
+    stats.median = bench_percentile(sorted, count, 50);
+    stats.p90    = bench_percentile(sorted, count, 90);
+    stats.p99    = bench_percentile(sorted, count, 99);
+
+    /* The deviations are only needed sorted, so they can overwrite the sorted copy */
+    for (size_t i = 0; i < count; ++i) {
+        sorted[i] = sorted[i] > stats.median ? sorted[i] - stats.median : stats.median - sorted[i];
+    }
+    qsort(sorted, count, sizeof (u64), bench_compare_u64);
+    stats.mad = bench_percentile(sorted, count, 50);
+
+    /* With a MAD of 0 (most runs took the same time) there is no scale to reject anything */
+    double limit = BENCH_OUTLIER_THRESHOLD * BENCH_MAD_SCALE * stats.mad;
+
+    /* Welford, so the variance does not lose precision on large times */
+    size_t kept = 0;
+    double mean = 0.0;
+    double m2   = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        double time = (double)bench->samples[i];
+        double distance = time > stats.median ? time - stats.median : stats.median - time;
+        if (stats.mad > 0 && distance > limit) continue;
+
+        ++kept;
+        double delta = time - mean;
+        mean += delta / kept;
+        m2   += delta * (time - mean);
+    }
+
+    stats.outliers = count - kept;
+    stats.mean     = mean;
+    stats.stddev   = kept > 1 ? bench_sqrt(m2 / (kept - 1)) : 0.0;
+    stats.cv       = mean > 0.0 ? stats.stddev / mean : 0.0;
+    /* Normal approximation, good enough from the minimum of runs on */
+    stats.precision = mean > 0.0 && kept > 0 ? 1.96 * stats.stddev / bench_sqrt((double)kept) / mean : 0.0;
+    stats.converged = stats.precision <= bench->config.target_precision;
+
+    return stats;
+}
+
+internal bool bench_next(bench_t *bench) {
+
+    const bench_config_t *config = &bench->config;
+
+    if (bench->warmup_done < config->warmup_runs) return true;
+    if (bench->count < config->min_runs)          return true;
+    if (bench->count >= config->max_runs)         return false;
+    if (bench->total_time >= config->max_time_ns) return false;
+
+    /* Checking sorts the samples, so it is only done every 1/8 more runs */
+    if (bench->count >= bench->next_check) {
+        if (bench_stats(bench).converged) return false;
+
+        size_t step = bench->count / 8;
+        bench->next_check = bench->count + (step > 0 ? step : 1);
+    }
+
+    return true;
+}
+
+internal bool bench_record(bench_t *bench, u64 time) {
+
+    if (bench->warmup_done < bench->config.warmup_runs) {
+        ++bench->warmup_done;
+        return false;
+    }
+
+    assert(bench->count < bench->config.max_runs && "More runs than bench_next allowed");
+
+    bench->samples[bench->count++] = time;
+    bench->total_time += time;
+
+    return true;
+}
+
+#endif /* ifndef BENCH_H */
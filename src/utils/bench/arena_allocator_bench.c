@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../macros.h"
+
+#define ALLOC_ARENA_IMPL
+#include "../allocator.h"
+
+#include "microbench.h"
+
+#define ALLOC_COUNT 4096
+#define MAX_ALLOC_SIZE 4096
+
+typedef struct {
+    size_t           size;
+    /* The arena being measured, NULL for malloc */
+    arena_context_t *arena;
+    void            *pointers[ALLOC_COUNT];
+} alloc_ctx_t;
+
+static void reset_arena(void *ctx) {
+    alloc_ctx_t *alloc = ctx;
+    arena_reset(alloc->arena);
+}
+
+static void free_all(void *ctx) {
+    alloc_ctx_t *alloc = ctx;
+    for (size_t i = 0; i < ALLOC_COUNT; ++i) {
+        free(alloc->pointers[i]);
+        alloc->pointers[i] = NULL;
+    }
+}
+
+/* The memory is not touched, only the bookkeeping of the allocator is measured (no bytes/cycle) */
+static void arena_allocs(void *ctx) {
+    alloc_ctx_t *alloc = ctx;
+    for (size_t i = 0; i < ALLOC_COUNT; ++i) {
+        alloc->pointers[i] = arena_alloc(alloc->arena, alloc->size);
+    }
+    microbench_sink((u64)alloc->pointers[ALLOC_COUNT - 1]);
+}
+
+static void malloc_allocs(void *ctx) {
+    alloc_ctx_t *alloc = ctx;
+    for (size_t i = 0; i < ALLOC_COUNT; ++i) {
+        alloc->pointers[i] = malloc(alloc->size);
+    }
+    microbench_sink((u64)alloc->pointers[ALLOC_COUNT - 1]);
+}
+
+int main(void) {
+
+    static const size_t sizes[] = { 16, 256, MAX_ALLOC_SIZE };
+
+    /* Room for every allocation of the largest size, with the alignment padding */
+    size_t buffer_size = ALLOC_COUNT * (MAX_ALLOC_SIZE + ARENA_DEFAULT_ALIGN) + KB(4);
+    u8 *buffer = malloc(buffer_size);
+
+    /* The same small starting capacity as the solution arena of the runner */
+    arena_context_t malloc_arena  = arena_init(4096, ARENA_MALLOC_BACKEND | ARENA_FAST_ALLOC | ARENA_GROWABLE, NULL, NULL);
+    arena_context_t virtual_arena = arena_init(4096, ARENA_VIRTUAL_BACKEND | ARENA_FAST_ALLOC | ARENA_GROWABLE, NULL, NULL);
+
+    static const char *backends[] = { "buffer", "malloc", "virtual" };
+    arena_context_t *arenas[] = { arena_from_buf(buffer, buffer_size), &malloc_arena, &virtual_arena };
+
+    alloc_ctx_t *ctx = calloc(1, sizeof (alloc_ctx_t));
+
+    microbench_header("arena_alloc (reset before every run)");
+
+    for (size_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s) {
+        char params[64];
+        ctx->size = sizes[s];
+
+        for (size_t b = 0; b < sizeof (backends) / sizeof (backends[0]); ++b) {
+            snprintf(params, sizeof (params), "size=%zu backend=%s", sizes[s], backends[b]);
+            ctx->arena = arenas[b];
+            microbench_run("arena_alloc", params, &(microbench_t) {
+                .ops = ALLOC_COUNT, .setup = reset_arena, .run = arena_allocs, .ctx = ctx,
+            });
+        }
+
+        /* What the arenas replace */
+        snprintf(params, sizeof (params), "size=%zu", sizes[s]);
+        ctx->arena = NULL;
+        /* The pointers still point into the arenas */
+        memset(ctx->pointers, 0, sizeof (ctx->pointers));
+        microbench_run("malloc", params, &(microbench_t) {
+            .ops = ALLOC_COUNT, .setup = free_all, .run = malloc_allocs, .ctx = ctx,
+        });
+        free_all(ctx);
+    }
+
+    free(ctx);
+    arena_destroy(&malloc_arena);
+    arena_destroy(&virtual_arena);
+    free(buffer);
+
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../macros.h"
+
+#undef ALLOC_STD_IMPL
+#define ALLOC_STD_IMPL
+#include "../allocator.h"
+
+#define STRING_UTILS_IMPL
+#include "../string_utils.h"
+
+#define BIGINT_IMPL
+#include "../bigint.h"
+
+#include "microbench.h"
+
+/* Multiplications per run, one is too short to time for small numbers */
+#define MUL_COUNT 64
+
+typedef struct {
+    bigint_t num;
+    bigint_t other;
+    /* Overwritten with num before every run, the products are computed in place */
+    bigint_t products[MUL_COUNT];
+} mul_ctx_t;
+
+/* A number with exactly limbs digits in base 2^32 */
+static bigint_t random_bigint(size_t limbs, u64 *seed) {
+
+    bigint_t result = bigint_with_capacity(limbs, &global_std_allocator);
+
+    for (size_t i = 0; i < limbs; ++i) {
+        u32 limb = (u32)microbench_random(seed);
+        if (i + 1 == limbs && limb == 0) limb = 1;
+        result.items = da_append(result.items, &result.array_info, &limb);
+    }
+
+    return result;
+}
+
+static void copy_operands(void *ctx) {
+    mul_ctx_t *mul = ctx;
+    for (size_t i = 0; i < MUL_COUNT; ++i) {
+        bigint_copy(&mul->products[i], &mul->num);
+    }
+}
+
+static void multiply(void *ctx) {
+    mul_ctx_t *mul = ctx;
+    for (size_t i = 0; i < MUL_COUNT; ++i) {
+        bigint_mul_in(&mul->products[i], &mul->other);
+    }
+    microbench_sink(mul->products[MUL_COUNT - 1].items[0]);
+}
+
+int main(void) {
+
+    /* Limbs of both operands, the multiplication is schoolbook so the cost is their product */
+    static const struct { size_t num_limbs, other_limbs; } cases[] = {
+        {   1,   1 },
+        {   8,   8 },
+        {  64,  64 },
+        { 512, 512 },
+        { 512,   1 },
+    };
+
+    microbench_header("bigint_mul_in (base 2^32)");
+
+    u64 seed = 1;
+    for (size_t c = 0; c < sizeof (cases) / sizeof (cases[0]); ++c) {
+        mul_ctx_t *ctx = calloc(1, sizeof (mul_ctx_t));
+        ctx->num   = random_bigint(cases[c].num_limbs, &seed);
+        ctx->other = random_bigint(cases[c].other_limbs, &seed);
+        for (size_t i = 0; i < MUL_COUNT; ++i) {
+            ctx->products[i] = bigint_with_capacity(16, &global_std_allocator);
+        }
+
+        char params[64];
+        snprintf(params, sizeof (params), "limbs=%zux%zu", cases[c].num_limbs, cases[c].other_limbs);
+
+        size_t operand_bytes = (cases[c].num_limbs + cases[c].other_limbs) * sizeof (u32);
+        microbench_run("bigint_mul_in", params, &(microbench_t) {
+            .ops = MUL_COUNT, .bytes = MUL_COUNT * operand_bytes, .setup = copy_operands, .run = multiply, .ctx = ctx,
+        });
+
+        for (size_t i = 0; i < MUL_COUNT; ++i) {
+            allocator_free(&global_std_allocator, ctx->products[i].items, 0);
+        }
+        allocator_free(&global_std_allocator, ctx->num.items, 0);
+        allocator_free(&global_std_allocator, ctx->other.items, 0);
+        free(ctx);
+    }
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../macros.h"
+
+#include "../allocator.h"
+#include "../da.h"
+
+#include "microbench.h"
+
+#define MAX_ITEM_SIZE 64
+
+typedef struct {
+    size_t       count;
+    /* Already reserved for count items, so only the copies are measured */
+    bool         reserved;
+    u8           item[MAX_ITEM_SIZE];
+    void        *array;
+    array_info_t info;
+} append_ctx_t;
+
+static void clear_array(void *ctx) {
+
+    append_ctx_t *append = ctx;
+
+    if (append->reserved) {
+        append->info.count = 0;
+        append->array = da_reserve(append->array, &append->info, append->count);
+        return;
+    }
+
+    allocator_free(append->info.allocator, append->array, append->info.capacity * append->info.item_size);
+    append->array         = NULL;
+    append->info.count    = 0;
+    append->info.capacity = 0;
+}
+
+static void append_items(void *ctx) {
+
+    append_ctx_t *append = ctx;
+
+    for (size_t i = 0; i < append->count; ++i) {
+        append->item[0] = (u8)i;
+        append->array = da_append(append->array, &append->info, append->item);
+    }
+
+    microbench_sink((u64)append->array);
+}
+
+int main(void) {
+
+    static const size_t item_sizes[] = { 4, 16, MAX_ITEM_SIZE };
+    static const size_t counts[]     = { 1024, 65536, 1048576 };
+
+    microbench_header("da_append (std allocator)");
+
+    for (size_t s = 0; s < sizeof (item_sizes) / sizeof (item_sizes[0]); ++s) {
+        for (size_t c = 0; c < sizeof (counts) / sizeof (counts[0]); ++c) {
+            for (int reserved = 0; reserved <= 1; ++reserved) {
+                append_ctx_t ctx = {
+                    .count    = counts[c],
+                    .reserved = reserved,
+                    .info     = { .item_size = item_sizes[s], .allocator = &global_std_allocator },
+                };
+
+                char params[64];
+                snprintf(params, sizeof (params), "n=%zu item=%zu%s", counts[c], item_sizes[s], reserved ? " reserved" : "");
+
+                /* Starts from an empty array every run, growing it is part of appending */
+                microbench_run("da_append", params, &(microbench_t) {
+                    .ops = ctx.count, .bytes = ctx.count * item_sizes[s], .setup = clear_array, .run = append_items, .ctx = &ctx,
+                });
+
+                allocator_free(ctx.info.allocator, ctx.array, ctx.info.capacity * ctx.info.item_size);
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../macros.h"
+
+#define ALLOC_ARENA_IMPL
+#include "../allocator.h"
+#define STRING_UTILS_IMPL
+#include "../string_utils.h"
+
+#define HM_IMPL
+#include "../hashmap.h"
+#include "../hash_utils.h"
+
+#include "microbench.h"
+
+enum key_distribution {
+    /* 0, 1, 2, ... */
+    KEYS_SEQUENTIAL,
+    /* Uniform over all u64 */
+    KEYS_RANDOM,
+    /* 0, 64, 128, ...: int64_hash is the identity, so they pile up on few buckets */
+    KEYS_STRIDED,
+};
+
+#define KEY_STRIDE 64
+
+typedef struct {
+    size_t    count;
+    u64      *keys;
+    /* The keys again, shuffled, so lookups do not walk the table in insertion order */
+    u64      *hits;
+    /* Keys that are not in the map */
+    u64      *misses;
+    hashmap_t map;
+} hashmap_ctx_t;
+
+static u64 make_key(enum key_distribution distribution, size_t i, u64 *seed) {
+    switch (distribution) {
+        case KEYS_SEQUENTIAL: return i;
+        case KEYS_RANDOM:     return microbench_random(seed);
+        case KEYS_STRIDED:    return i * KEY_STRIDE;
+        default:              UNREACHABLE("key distribution");
+    }
+}
+
+static void make_keys(hashmap_ctx_t *ctx, enum key_distribution distribution, size_t count) {
+
+    ctx->count  = count;
+    ctx->keys   = malloc(count * sizeof (u64));
+    ctx->hits   = malloc(count * sizeof (u64));
+    ctx->misses = malloc(count * sizeof (u64));
+
+    u64 seed = count;
+    for (size_t i = 0; i < count; ++i) {
+        ctx->keys[i] = make_key(distribution, i, &seed);
+        ctx->hits[i] = ctx->keys[i];
+    }
+
+    /* Past the last key, or in between two of them (random keys hardly ever collide) */
+    for (size_t i = 0; i < count; ++i) {
+        u64 key = make_key(distribution, count + i, &seed);
+        ctx->misses[i] = distribution == KEYS_STRIDED ? ctx->keys[i] + 1 : key;
+    }
+
+    for (size_t i = count - 1; i > 0; --i) {
+        size_t j = microbench_random(&seed) % (i + 1);
+        u64 temp     = ctx->hits[i];
+        ctx->hits[i] = ctx->hits[j];
+        ctx->hits[j] = temp;
+    }
+}
+
+static void free_keys(hashmap_ctx_t *ctx) {
+    free(ctx->keys);
+    free(ctx->hits);
+    free(ctx->misses);
+}
+
+static void clear_map(void *ctx) {
+    hashmap_ctx_t *hm = ctx;
+    hm_destroy(&hm->map);
+    hm->map = hm_init(&global_std_allocator, int64_hash, int64_eq, 0, NULL);
+}
+
+static void insert_keys(void *ctx) {
+    hashmap_ctx_t *hm = ctx;
+    for (size_t i = 0; i < hm->count; ++i) {
+        hm_insert(&hm->map, &hm->keys[i], &hm->keys[i], NULL);
+    }
+}
+
+static void get_hits(void *ctx) {
+    hashmap_ctx_t *hm = ctx;
+    u64 found = 0;
+    for (size_t i = 0; i < hm->count; ++i) {
+        found += hm_get(&hm->map, &hm->hits[i]) != NULL;
+    }
+    microbench_sink(found);
+}
+
+static void get_misses(void *ctx) {
+    hashmap_ctx_t *hm = ctx;
+    u64 found = 0;
+    for (size_t i = 0; i < hm->count; ++i) {
+        found += hm_get(&hm->map, &hm->misses[i]) != NULL;
+    }
+    microbench_sink(found);
+}
+
+int main(void) {
+
+    static const struct { enum key_distribution distribution; const char *name; } distributions[] = {
+        { KEYS_SEQUENTIAL, "sequential" },
+        { KEYS_RANDOM,     "random"     },
+        { KEYS_STRIDED,    "strided"    },
+    };
+    static const size_t counts[] = { 1024, 16384, 262144 };
+
+    microbench_header("hashmap (u64 keys, int64_hash)");
+
+    for (size_t d = 0; d < sizeof (distributions) / sizeof (distributions[0]); ++d) {
+        for (size_t c = 0; c < sizeof (counts) / sizeof (counts[0]); ++c) {
+            hashmap_ctx_t ctx = {0};
+            make_keys(&ctx, distributions[d].distribution, counts[c]);
+            ctx.map = hm_init(&global_std_allocator, int64_hash, int64_eq, 0, NULL);
+
+            char params[64];
+            snprintf(params, sizeof (params), "n=%zu keys=%s", counts[c], distributions[d].name);
+
+            /* Starts from an empty map every run, growing it is part of inserting */
+            microbench_run("hm_insert", params, &(microbench_t) {
+                .ops = ctx.count, .bytes = ctx.count * sizeof (u64), .setup = clear_map, .run = insert_keys, .ctx = &ctx,
+            });
+
+            /* The last run left every key in the map */
+            microbench_run("hm_get hit", params, &(microbench_t) {
+                .ops = ctx.count, .bytes = ctx.count * sizeof (u64), .run = get_hits, .ctx = &ctx,
+            });
+            microbench_run("hm_get miss", params, &(microbench_t) {
+                .ops = ctx.count, .bytes = ctx.count * sizeof (u64), .run = get_misses, .ctx = &ctx,
+            });
+
+            hm_destroy(&ctx.map);
+            free_keys(&ctx);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+/*
+ * Microbenchmarks of the utilities, one case at a time.
+ *
+ * A case is a run function that does ops operations (parse ops numbers, insert ops keys,
+ * ...) over bytes bytes of data, and an optional setup function that puts the state back
+ * before every run (clearing a hashmap, resetting an arena) without being measured. The
+ * runs go through bench.h, and the median run is reported per operation:
+ *
+ *     microbench_header("hashmap");
+ *     microbench_run("hm_insert", "n=1024 keys=random", &(microbench_t) {
+ *         .ops = 1024, .bytes = 1024 * sizeof (u64), .setup = clear, .run = insert, .ctx = &state,
+ *     });
+ *
+ * The runs are timed with timer.h, and the cycles are its TSC ticks, which tick at the
+ * nominal frequency of the CPU: with turbo the cores run more cycles than that, with
+ * power saving fewer. When the timer falls back to clock_gettime there are no cycles.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../bench.h"
+#include "../timer.h"
+#include "../typedefs.h"
+
+/* Limits of each case, the suite covers a few dozen of them */
+#ifndef MICROBENCH_MAX_TIME_NS
+#define MICROBENCH_MAX_TIME_NS (200 * 1000 * 1000)
+#endif /* ifndef MICROBENCH_MAX_TIME_NS */
+
+#define MICROBENCH_MAX_RUNS 1000
+
+typedef struct {
+    /* Operations done by one call of run */
+    size_t ops;
+    /* Bytes read or written by one call of run, 0 if bytes/cycle means nothing for the case */
+    size_t bytes;
+    /* Called before every run, not measured (may be NULL) */
+    void (*setup)(void *ctx);
+    void (*run)(void *ctx);
+    void *ctx;
+} microbench_t;
+
+/* Prints the title of a group of cases and the columns of the results */
+internal void microbench_header(const char *title);
+
+/*
+ * Benchmarks one case and prints its row.
+ *
+ * name   - The function being measured.
+ * params - Size and distribution of the case, as free text.
+ */
+internal void microbench_run(const char *name, const char *params, const microbench_t *bench);
+
+/* Keeps the compiler from dropping the computation of value */
+internal inline void microbench_sink(u64 value) {
+    __asm__ volatile ("" : : "r"(value) : "memory");
+}
+
+/* splitmix64, so every run of the suite uses the same keys */
+internal inline u64 microbench_random(u64 *state) {
+    u64 z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+internal void microbench_header(const char *title) {
+    printf("\n%s\n", title);
+    printf("  %-16s %-28s %10s %10s %11s %8s %6s\n",
+           "function", "params", "ns/op", "cycles/op", "bytes/cycle", "ci95", "runs");
+}
+
+internal void microbench_run(const char *name, const char *params, const microbench_t *bench) {
+
+    bench_config_t config = BENCH_DEFAULT_CONFIG;
+    config.max_runs    = MICROBENCH_MAX_RUNS;
+    config.max_time_ns = MICROBENCH_MAX_TIME_NS;
+
+    bench_t times;
+    bench_init(&times, &config);
+
+    /* The cycles of the measured runs, in the same order as the times */
+    u64 *cycles = malloc(config.max_runs * sizeof (u64));
+
+    while (bench_next(&times)) {
+        if (bench->setup) bench->setup(bench->ctx);
+
+        u64 start = timer_ticks();
+        bench->run(bench->ctx);
+        u64 ticks = timer_ticks_end() - start;
+
+        if (bench_record(&times, timer_ticks_to_ns(ticks))) {
+            cycles[times.count - 1] = timer_state.source == TIMER_TSC ? ticks : 0;
+        }
+    }
+
+    bench_stats_t stats = bench_stats(&times);
+
+    qsort(cycles, times.count, sizeof (u64), bench_compare_u64);
+    u64 median_cycles = bench_percentile(cycles, times.count, 50);
+
+    double ops = (double)(bench->ops > 0 ? bench->ops : 1);
+
+    printf("  %-16s %-28s %10.2f ", name, params, (double)stats.median / ops);
+
+    if (median_cycles > 0) {
+        printf("%10.2f ", (double)median_cycles / ops);
+    } else {
+        printf("%10s ", "-");
+    }
+
+    if (bench->bytes > 0 && median_cycles > 0) {
+        printf("%11.3f", (double)bench->bytes / (double)median_cycles);
+    } else {
+        printf("%11s", "-");
+    }
+
+    printf(" %7.1f%% %6zu\n", stats.precision * 100.0, stats.runs);
+    fflush(stdout);
+
+    free(cycles);
+    bench_free(&times);
+}
+
+#endif /* ifndef MICROBENCH_H */
@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../macros.h"
+
+#define STRING_UTILS_IMPL
+#include "../string_utils.h"
+#include "../parsing_helpers.h"
+
+#include "microbench.h"
+
+/* Numbers in each list, separated by commas like the ranges of day02 */
+#define NUMBER_COUNT 4096
+
+typedef struct {
+    char  *text;
+    size_t length;
+} number_list_t;
+
+/*
+ * Writes NUMBER_COUNT comma separated numbers.
+ *
+ * min_digits, max_digits - Each number has a length picked uniformly in between.
+ */
+static number_list_t make_list(u32 min_digits, u32 max_digits, u64 seed) {
+
+    number_list_t list = {
+        .text = malloc(NUMBER_COUNT * 21),
+    };
+
+    for (size_t i = 0; i < NUMBER_COUNT; ++i) {
+        u32 digits = min_digits + microbench_random(&seed) % (max_digits - min_digits + 1);
+
+        /* No leading zeros, the first digit is 1-9 */
+        list.text[list.length++] = '1' + microbench_random(&seed) % 9;
+        for (u32 d = 1; d < digits; ++d) {
+            list.text[list.length++] = '0' + microbench_random(&seed) % 10;
+        }
+
+        if (i + 1 < NUMBER_COUNT) list.text[list.length++] = ',';
+    }
+
+    return list;
+}
+
+static void parse_list(void *ctx) {
+
+    number_list_t *list = ctx;
+    string_t rest = { .chars = list->text, .count = list->length };
+
+    u64 sum = 0;
+    while (rest.count > 0) {
+        sum += parse_u64(rest, &rest);
+        /* Skip the comma */
+        if (rest.count > 0) {
+            rest.chars++;
+            rest.count--;
+        }
+    }
+
+    microbench_sink(sum);
+}
+
+int main(void) {
+
+    static const struct { u32 min_digits, max_digits; const char *params; } cases[] = {
+        {  1,  1, "digits=1"    },
+        {  4,  4, "digits=4"    },
+        { 10, 10, "digits=10"   },
+        { 19, 19, "digits=19"   },
+        {  1, 19, "digits=1-19" },
+    };
+
+    microbench_header("parse_u64");
+
+    for (size_t i = 0; i < sizeof (cases) / sizeof (cases[0]); ++i) {
+        number_list_t list = make_list(cases[i].min_digits, cases[i].max_digits, i + 1);
+
+        microbench_run("parse_u64", cases[i].params, &(microbench_t) {
+            .ops   = NUMBER_COUNT,
+            .bytes = list.length,
+            .run   = parse_list,
+            .ctx   = &list,
+        });
+
+        free(list.text);
+    }
+
+    return 0;
+}
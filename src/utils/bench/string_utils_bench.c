@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../macros.h"
+
+#define ALLOC_ARENA_IMPL
+#include "../allocator.h"
+#define STRING_UTILS_IMPL
+#include "../string_utils.h"
+
+#include "microbench.h"
+
+#define VALUE_COUNT 4096
+
+typedef struct {
+    u64              values[VALUE_COUNT];
+    /* Digits of all the values */
+    size_t           length;
+    const allocator_t *allocator;
+    arena_context_t *arena_ctx;
+} format_ctx_t;
+
+/* Values with a fixed number of digits (digits 0: any value up to UINT64_MAX) */
+static void make_values(format_ctx_t *ctx, u32 digits, u64 seed) {
+
+    u64 low = 1;
+    for (u32 d = 1; d < digits; ++d) low *= 10;
+    /* 20 digits go up to UINT64_MAX, not 10^20 - 1 */
+    u64 span = digits < 20 ? 9 * low : UINT64_MAX - low;
+
+    ctx->length = 0;
+    for (size_t i = 0; i < VALUE_COUNT; ++i) {
+        u64 value = microbench_random(&seed);
+        if (digits > 0) value = low + value % span;
+        ctx->values[i] = value;
+
+        for (u64 v = value; ; v /= 10) {
+            ++ctx->length;
+            if (v < 10) break;
+        }
+    }
+}
+
+static void reset_arena(void *ctx) {
+    format_ctx_t *format = ctx;
+    if (format->arena_ctx) arena_reset(format->arena_ctx);
+}
+
+static void format_values(void *ctx) {
+
+    format_ctx_t *format = ctx;
+
+    for (size_t i = 0; i < VALUE_COUNT; ++i) {
+        string_builder_t sb = sb_from_u64(format->values[i], format->allocator);
+        microbench_sink((u64)sb.items[0]);
+        /* The arena is reset before every run instead */
+        if (!format->arena_ctx) {
+            allocator_free(format->allocator, sb.items, sb.array_info.capacity);
+        }
+    }
+}
+
+int main(void) {
+
+    static const struct { u32 digits; const char *params; } cases[] = {
+        {  1, "digits=1"   },
+        { 10, "digits=10"  },
+        { 20, "digits=20"  },
+        {  0, "digits=any" },
+    };
+
+    arena_context_t arena_ctx = arena_init(VALUE_COUNT * 64, ARENA_MALLOC_BACKEND | ARENA_FAST_ALLOC | ARENA_GROWABLE, NULL, NULL);
+    allocator_t arena = { .interface = &arena_interface, .alloc_ctx = &arena_ctx };
+
+    format_ctx_t *ctx = malloc(sizeof (format_ctx_t));
+
+    microbench_header("sb_from_u64");
+
+    for (size_t i = 0; i < sizeof (cases) / sizeof (cases[0]); ++i) {
+        make_values(ctx, cases[i].digits, i + 1);
+
+        char params[64];
+
+        /* The arena leaves only the formatting, with malloc every call also pays for the heap */
+        snprintf(params, sizeof (params), "%s alloc=arena", cases[i].params);
+        ctx->allocator = &arena;
+        ctx->arena_ctx = &arena_ctx;
+        microbench_run("sb_from_u64", params, &(microbench_t) {
+            .ops = VALUE_COUNT, .bytes = ctx->length, .setup = reset_arena, .run = format_values, .ctx = ctx,
+        });
+
+        snprintf(params, sizeof (params), "%s alloc=std", cases[i].params);
+        ctx->allocator = &global_std_allocator;
+        ctx->arena_ctx = NULL;
+        microbench_run("sb_from_u64", params, &(microbench_t) {
+            .ops = VALUE_COUNT, .bytes = ctx->length, .run = format_values, .ctx = ctx,
+        });
+    }
+
+    free(ctx);
+    arena_destroy(&arena_ctx);
+
+    return 0;
+}
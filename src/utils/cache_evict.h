@@ -0,0 +1,119 @@
+#ifndef CACHE_EVICT_H
+#define CACHE_EVICT_H
+
+/*
+ * Evicts the CPU caches by streaming through a buffer larger than the last level cache,
+ * so a benchmark can measure a part the way it runs the first time, with its input and
+ * data in memory instead of L1/L2.
+ *
+ * Each core has its own L1/L2, so every thread that runs the part has to evict its
+ * own caches: the buffer is split in slices, one per thread, each larger than an L2.
+ *
+ *     cache_evictor_t evictor;
+ *     cache_evictor_init(&evictor, thread_count);
+ *     ...
+ *     cache_evict_slice(&evictor, thread_idx);    (on each thread)
+ *     ...
+ *     cache_evictor_free(&evictor);
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "typedefs.h"
+
+/* Used when the size of the last level cache can not be read */
+#ifndef CACHE_EVICT_DEFAULT_LLC
+#define CACHE_EVICT_DEFAULT_LLC (32 * 1024 * 1024)
+#endif /* ifndef CACHE_EVICT_DEFAULT_LLC */
+
+/* Smallest slice per thread, larger than the L2 of current cores */
+#define CACHE_EVICT_MIN_SLICE (4 * 1024 * 1024)
+
+#define CACHE_EVICT_LINE 64
+
+typedef struct {
+    u8    *buffer;
+    size_t size;
+    size_t slice_size;
+} cache_evictor_t;
+
+/* Size of the largest cache of cpu0 (in bytes), from sysfs */
+internal size_t cache_llc_size(void);
+
+/* Allocates a buffer of twice the last level cache, at least one minimum slice per thread */
+internal bool cache_evictor_init(cache_evictor_t *evictor, size_t thread_count);
+
+internal void cache_evictor_free(cache_evictor_t *evictor);
+
+/* Writes to every cache line of the slice of thread_idx */
+internal void cache_evict_slice(cache_evictor_t *evictor, size_t thread_idx);
+
+internal size_t cache_llc_size(void) {
+
+    size_t largest = 0;
+
+    for (u32 index = 0; index < 8; ++index) {
+        char path[128];
+        snprintf(path, sizeof (path), "/sys/devices/system/cpu/cpu0/cache/index%u/size", index);
+
+        FILE *file = fopen(path, "r");
+        if (!file) break;
+
+        size_t size = 0;
+        char   unit = 0;
+        if (fscanf(file, "%zu%c", &size, &unit) >= 1) {
+            if (unit == 'K') size *= 1024;
+            if (unit == 'M') size *= 1024 * 1024;
+            if (size > largest) largest = size;
+        }
+
+        fclose(file);
+    }
+
+    return largest > 0 ? largest : CACHE_EVICT_DEFAULT_LLC;
+}
+
+internal bool cache_evictor_init(cache_evictor_t *evictor, size_t thread_count) {
+
+    if (thread_count == 0) thread_count = 1;
+
+    size_t slice = 2 * cache_llc_size() / thread_count;
+    if (slice < CACHE_EVICT_MIN_SLICE) slice = CACHE_EVICT_MIN_SLICE;
+    slice = (slice + CACHE_EVICT_LINE - 1) / CACHE_EVICT_LINE * CACHE_EVICT_LINE;
+
+    evictor->slice_size = slice;
+    evictor->size       = slice * thread_count;
+    evictor->buffer     = malloc(evictor->size);
+
+    if (!evictor->buffer) return false;
+
+    /* Fault the pages in now, so evicting does not measure page faults */
+    memset(evictor->buffer, 1, evictor->size);
+
+    return true;
+}
+
+internal void cache_evictor_free(cache_evictor_t *evictor) {
+    free(evictor->buffer);
+    evictor->buffer = NULL;
+    evictor->size   = 0;
+}
+
+internal void cache_evict_slice(cache_evictor_t *evictor, size_t thread_idx) {
+
+    u8 *slice = evictor->buffer + thread_idx * evictor->slice_size;
+
+    /* Writing (instead of reading) also pushes out dirty lines of the part's data */
+    for (size_t i = 0; i < evictor->slice_size; i += CACHE_EVICT_LINE) {
+        slice[i]++;
+    }
+
+    /* The buffer is never read, keep the compiler from dropping the writes */
+    __asm__ volatile ("" : : "r"(slice) : "memory");
+}
+
+#endif /* ifndef CACHE_EVICT_H */
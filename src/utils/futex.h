@@ -0,0 +1,27 @@
+#ifndef FUTEX_H
+#define FUTEX_H
+
+/*
+ * Thin wrappers around the Linux futex syscall. Only the private (process local)
+ * variants are used, since every waiter lives in the same address space.
+ */
+
+#include <linux/futex.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "typedefs.h"
+
+/* Sleeps while *addr == expected. Might return spuriously, always recheck the condition. */
+internal inline void futex_wait(atomic_uint_least32_t *addr, u32 expected) {
+    syscall(SYS_futex, (u32 *)addr, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+/* Wakes up to waiter_count threads sleeping on addr */
+internal inline void futex_wake(atomic_uint_least32_t *addr, u32 waiter_count) {
+    syscall(SYS_futex, (u32 *)addr, FUTEX_WAKE_PRIVATE, waiter_count, NULL, NULL, 0);
+}
+
+#endif /* ifndef FUTEX_H */
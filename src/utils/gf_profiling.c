@@ -1,7 +1,10 @@
 // ------------- Configuration -------------
-#define GF_PROFILING_BUFFER_BYTES (64 * 1024 * 1024)
-#define GF_PROFILING_CLOCK CLOCK_MONOTONIC
-// #define GF_PROFILING_CLOCK CLOCK_THREAD_CPUTIME_ID
+// Size of the ring buffer of each thread (a power of two), the oldest events are overwritten.
+#ifndef GF_PROFILING_THREAD_BUFFER_BYTES
+#define GF_PROFILING_THREAD_BUFFER_BYTES (16 * 1024 * 1024)
+#endif
+// Timestamps are ticks of utils/timer.h (TSC, or ns if it fell back to clock_gettime),
+// gfProfilingTicksPerMs converts them.
 // -----------------------------------------
 
 /*
@@ -49,9 +52,19 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
+#include <string.h>
 #include <assert.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/auxv.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#include "timer.h"
 
 #ifdef __cplusplus
 #define GF_PROFILING_EXTERN extern "C"
@@ -64,22 +77,75 @@ typedef struct GfProfilingEntry {
 	uint64_t timeStamp;
 } GfProfilingEntry;
 
-static __thread bool gfProfilingEnabledOnThisThread;
+// The events of one thread. Only that thread writes them, the buffers are never freed so the
+// events of the threads that already exited can still be read after GfProfilingStop.
+typedef struct GfProfilingThread {
+	GfProfilingEntry *entries;
+	size_t size;
+	// Events written since GfProfilingStart, the next one goes to entries[position & (size - 1)].
+	uint64_t position;
+	// Kernel thread id, and the order in which the threads recorded their first event.
+	uint32_t threadId;
+	uint32_t index;
+	struct GfProfilingThread *next;
+} GfProfilingThread;
+
+static __thread GfProfilingThread *gfProfilingThisThread;
 static bool gfProfilingEnabled;
 static size_t gfProfilingBufferSize;
-GfProfilingEntry *gfProfilingBuffer;
-uintptr_t gfProfilingBufferPosition;
+// Every thread that recorded an event, the most recent first.
+GfProfilingThread *gfProfilingThreads;
+uint32_t gfProfilingThreadCount;
 uint64_t gfProfilingTicksPerMs;
 
+// Allocates the buffer of the calling thread and adds it to gfProfilingThreads.
+static __attribute__((no_instrument_function))
+GfProfilingThread *GfProfilingThreadStart() {
+	GfProfilingThread *thread = (GfProfilingThread *) calloc(1, sizeof(GfProfilingThread));
+	if (!thread) return NULL;
+
+	// Large enough to be mmapped by malloc, the pages are only faulted in as they are written.
+	thread->entries = (GfProfilingEntry *) malloc(gfProfilingBufferSize * sizeof(GfProfilingEntry));
+	if (!thread->entries) {
+		free(thread);
+		return NULL;
+	}
+
+	thread->size = gfProfilingBufferSize;
+	thread->threadId = (uint32_t) syscall(SYS_gettid);
+	thread->index = __atomic_fetch_add(&gfProfilingThreadCount, 1, __ATOMIC_RELAXED);
+	thread->next = __atomic_load_n(&gfProfilingThreads, __ATOMIC_RELAXED);
+	while (!__atomic_compare_exchange_n(&gfProfilingThreads, &thread->next, thread, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+	return thread;
+}
+
+// Events still in the ring buffer of the thread, the oldest is GfProfilingThreadEntry(thread, 0).
+GF_PROFILING_EXTERN __attribute__((no_instrument_function))
+size_t GfProfilingThreadEntryCount(GfProfilingThread *thread) {
+	uint64_t position = __atomic_load_n(&thread->position, __ATOMIC_ACQUIRE);
+	return position < thread->size ? position : thread->size;
+}
+
+GF_PROFILING_EXTERN __attribute__((no_instrument_function))
+GfProfilingEntry *GfProfilingThreadEntry(GfProfilingThread *thread, size_t i) {
+	uint64_t position = __atomic_load_n(&thread->position, __ATOMIC_ACQUIRE);
+	uint64_t first = position < thread->size ? 0 : position - thread->size;
+	return &thread->entries[(first + i) & (thread->size - 1)];
+}
+
 #define GF_PROFILING_FUNCTION(_exiting) \
 	(void) callSite; \
 	\
-	if (gfProfilingBufferPosition < gfProfilingBufferSize && gfProfilingEnabledOnThisThread) { \
-		GfProfilingEntry *entry = (GfProfilingEntry *) &gfProfilingBuffer[gfProfilingBufferPosition++]; \
-		entry->thisFunction = thisFunction; \
-		struct timespec time; \
-		clock_gettime(GF_PROFILING_CLOCK, &time); \
-		entry->timeStamp = ((uint64_t) time.tv_sec * 1000000000 + time.tv_nsec) | ((uint64_t) _exiting << 63); \
+	if (__atomic_load_n(&gfProfilingEnabled, __ATOMIC_RELAXED)) { \
+		GfProfilingThread *thread = gfProfilingThisThread; \
+		if (!thread) thread = gfProfilingThisThread = GfProfilingThreadStart(); \
+		if (thread) { \
+			GfProfilingEntry *entry = &thread->entries[thread->position & (thread->size - 1)]; \
+			entry->thisFunction = thisFunction; \
+			entry->timeStamp = timer_ticks() | ((uint64_t) _exiting << 63); \
+			__atomic_store_n(&thread->position, thread->position + 1, __ATOMIC_RELEASE); \
+		} \
 	}
 
 GF_PROFILING_EXTERN __attribute__((no_instrument_function))
@@ -92,29 +158,274 @@ void __cyg_profile_func_exit(void *thisFunction, void *callSite) {
 	GF_PROFILING_FUNCTION(1);
 }
 
+// Starts recording on every thread, the events of a previous recording are discarded.
 GF_PROFILING_EXTERN __attribute__((no_instrument_function))
 void GfProfilingStart() {
 	assert(!gfProfilingEnabled);
-	assert(!gfProfilingEnabledOnThisThread);
 	assert(gfProfilingBufferSize);
-	gfProfilingEnabled = true;
-	gfProfilingEnabledOnThisThread = true;
-	gfProfilingBufferPosition = 0;
+
+	for (GfProfilingThread *thread = __atomic_load_n(&gfProfilingThreads, __ATOMIC_ACQUIRE); thread; thread = thread->next) {
+		__atomic_store_n(&thread->position, 0, __ATOMIC_RELAXED);
+	}
+
+	__atomic_store_n(&gfProfilingEnabled, true, __ATOMIC_RELEASE);
 }
 
 GF_PROFILING_EXTERN __attribute__((no_instrument_function))
 void GfProfilingStop() {
 	assert(gfProfilingEnabled);
-	assert(gfProfilingEnabledOnThisThread);
-	gfProfilingEnabled = false;
-	gfProfilingEnabledOnThisThread = false;
+	__atomic_store_n(&gfProfilingEnabled, false, __ATOMIC_RELEASE);
+}
+
+// ------------- Export -------------
+
+// A function of the executable, from its symbol table.
+typedef struct GfProfilingSymbol {
+	uintptr_t address;
+	size_t size;
+	const char *name;
+} GfProfilingSymbol;
+
+typedef struct GfProfilingSymbols {
+	GfProfilingSymbol *symbols;
+	size_t count;
+	// The executable, mapped while the names (which point into it) are used.
+	void *file;
+	size_t fileSize;
+} GfProfilingSymbols;
+
+static __attribute__((no_instrument_function))
+int GfProfilingCompareSymbols(const void *a, const void *b) {
+	uintptr_t x = ((const GfProfilingSymbol *) a)->address;
+	uintptr_t y = ((const GfProfilingSymbol *) b)->address;
+	return (x > y) - (x < y);
+}
+
+// Reads the functions of the running executable from its ELF symbol table, .symtab if it is not
+// stripped (it has the static functions, unlike dladdr which only sees the dynamic symbols),
+// .dynsym otherwise. The addresses are moved to where a PIE was loaded.
+static __attribute__((no_instrument_function))
+bool GfProfilingLoadSymbols(GfProfilingSymbols *symbols) {
+	memset(symbols, 0, sizeof(*symbols));
+
+	int fd = open("/proc/self/exe", O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(Elf64_Ehdr)) {
+		close(fd);
+		return false;
+	}
+
+	uint8_t *file = (uint8_t *) mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (file == MAP_FAILED) return false;
+
+	symbols->file = file;
+	symbols->fileSize = st.st_size;
+
+	Elf64_Ehdr *header = (Elf64_Ehdr *) file;
+	if (memcmp(header->e_ident, ELFMAG, SELFMAG) != 0 || header->e_ident[EI_CLASS] != ELFCLASS64
+			|| header->e_shoff + (size_t) header->e_shnum * sizeof(Elf64_Shdr) > symbols->fileSize) {
+		return false;
+	}
+
+	// A PIE is loaded anywhere, the program headers tell where: they are mapped at AT_PHDR.
+	uintptr_t base = 0;
+	if (header->e_type == ET_DYN) {
+		Elf64_Phdr *programHeaders = (Elf64_Phdr *) (file + header->e_phoff);
+		uintptr_t phdrAddress = header->e_phoff;
+		for (size_t i = 0; i < header->e_phnum; i++) {
+			if (programHeaders[i].p_type == PT_PHDR) phdrAddress = programHeaders[i].p_vaddr;
+		}
+		base = getauxval(AT_PHDR) - phdrAddress;
+	}
+
+	Elf64_Shdr *sections = (Elf64_Shdr *) (file + header->e_shoff);
+	Elf64_Shdr *table = NULL;
+	for (size_t i = 0; i < header->e_shnum; i++) {
+		if (sections[i].sh_type == SHT_SYMTAB) table = &sections[i];
+		if (sections[i].sh_type == SHT_DYNSYM && !table) table = &sections[i];
+	}
+	if (!table || table->sh_link >= header->e_shnum) return false;
+
+	Elf64_Sym *entries = (Elf64_Sym *) (file + table->sh_offset);
+	size_t entryCount = table->sh_size / sizeof(Elf64_Sym);
+	const char *names = (const char *) (file + sections[table->sh_link].sh_offset);
+
+	symbols->symbols = (GfProfilingSymbol *) malloc((entryCount + 1) * sizeof(GfProfilingSymbol));
+	if (!symbols->symbols) return false;
+
+	for (size_t i = 0; i < entryCount; i++) {
+		Elf64_Sym *entry = &entries[i];
+		if (ELF64_ST_TYPE(entry->st_info) != STT_FUNC || entry->st_shndx == SHN_UNDEF || !entry->st_value) continue;
+
+		GfProfilingSymbol *symbol = &symbols->symbols[symbols->count++];
+		symbol->address = base + entry->st_value;
+		symbol->size = entry->st_size;
+		symbol->name = names + entry->st_name;
+	}
+
+	qsort(symbols->symbols, symbols->count, sizeof(GfProfilingSymbol), GfProfilingCompareSymbols);
+	return true;
 }
 
+static __attribute__((no_instrument_function))
+void GfProfilingFreeSymbols(GfProfilingSymbols *symbols) {
+	free(symbols->symbols);
+	if (symbols->file) munmap(symbols->file, symbols->fileSize);
+	memset(symbols, 0, sizeof(*symbols));
+}
+
+// Name of the function at address, NULL if it is not in the symbol table.
+static __attribute__((no_instrument_function))
+const char *GfProfilingSymbolName(GfProfilingSymbols *symbols, void *address) {
+	uintptr_t target = (uintptr_t) address;
+	size_t low = 0, high = symbols->count;
+
+	// The first symbol past the address, the function is the one before it.
+	while (low < high) {
+		size_t middle = low + (high - low) / 2;
+		if (symbols->symbols[middle].address <= target) low = middle + 1;
+		else high = middle;
+	}
+
+	if (low == 0) return NULL;
+	GfProfilingSymbol *symbol = &symbols->symbols[low - 1];
+	return target < symbol->address + (symbol->size ? symbol->size : 1) ? symbol->name : NULL;
+}
+
+static __attribute__((no_instrument_function))
+void GfProfilingWriteJsonString(FILE *file, const char *string) {
+	fputc('"', file);
+	for (; *string; string++) {
+		if (*string == '"' || *string == '\\') fputc('\\', file);
+		if ((unsigned char) *string >= 0x20) fputc(*string, file);
+	}
+	fputc('"', file);
+}
+
+// A call as a complete event ("X", half the size of a begin and an end event). The times are
+// written as microseconds with integer arithmetic: a float would be printed with the decimal
+// comma of the locale set by the runner.
+static __attribute__((no_instrument_function))
+void GfProfilingWriteCall(FILE *file, GfProfilingSymbols *symbols, uint32_t processId, uint32_t threadId,
+		void *function, uint64_t startNs, uint64_t endNs) {
+	uint64_t duration = endNs - startNs;
+	fprintf(file, ",\n{\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%llu.%03llu,\"dur\":%llu.%03llu,\"name\":",
+			processId, threadId, (unsigned long long) (startNs / 1000), (unsigned long long) (startNs % 1000),
+			(unsigned long long) (duration / 1000), (unsigned long long) (duration % 1000));
+
+	const char *name = GfProfilingSymbolName(symbols, function);
+	if (name) {
+		GfProfilingWriteJsonString(file, name);
+	} else {
+		fprintf(file, "\"%p\"", function);
+	}
+	fprintf(file, "}");
+}
+
+// Writes the recorded events as a Chrome Trace Event JSON file (https://ui.perfetto.dev or
+// chrome://tracing), one track per thread. Call it after GfProfilingStop.
+//
+// A ring buffer that wrapped starts in the middle of calls, their exits are dropped; the calls
+// still open at the end are closed at the last event of the thread.
+GF_PROFILING_EXTERN __attribute__((no_instrument_function))
+bool GfProfilingExportChromeTrace(const char *path) {
+	assert(!gfProfilingEnabled);
+
+	FILE *file = fopen(path, "w");
+	if (!file) return false;
+
+	GfProfilingSymbols symbols;
+	if (!GfProfilingLoadSymbols(&symbols)) {
+		fprintf(stderr, "No symbol table in /proc/self/exe, the functions are named by address\n");
+	}
+
+	uint32_t processId = (uint32_t) getpid();
+
+	// Time 0 is the oldest event still in any buffer.
+	uint64_t origin = UINT64_MAX;
+	for (GfProfilingThread *thread = gfProfilingThreads; thread; thread = thread->next) {
+		if (!GfProfilingThreadEntryCount(thread)) continue;
+		uint64_t first = GfProfilingThreadEntry(thread, 0)->timeStamp & ~(1ULL << 63);
+		if (first < origin) origin = first;
+	}
+
+	// The name of the program for its track, from /proc/self/comm.
+	char processName[32] = "";
+	FILE *comm = fopen("/proc/self/comm", "r");
+	if (comm) {
+		if (!fgets(processName, sizeof(processName), comm)) processName[0] = 0;
+		processName[strcspn(processName, "\n")] = 0;
+		fclose(comm);
+	}
+
+	fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	fprintf(file, "{\"ph\":\"M\",\"pid\":%u,\"name\":\"process_name\",\"args\":{\"name\":", processId);
+	GfProfilingWriteJsonString(file, processName);
+	fprintf(file, "}}");
+
+	for (GfProfilingThread *thread = gfProfilingThreads; thread; thread = thread->next) {
+		size_t count = GfProfilingThreadEntryCount(thread);
+		if (!count) continue;
+
+		char threadName[32] = "main";
+		if (thread->threadId != processId) snprintf(threadName, sizeof(threadName), "thread %u", thread->index);
+		fprintf(file, ",\n{\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":\"%s\"}}",
+				processId, thread->threadId, threadName);
+		fprintf(file, ",\n{\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"name\":\"thread_sort_index\",\"args\":{\"sort_index\":%u}}",
+				processId, thread->threadId, thread->index);
+
+		// The calls still open, innermost last.
+		GfProfilingEntry *open = (GfProfilingEntry *) malloc(count * sizeof(GfProfilingEntry));
+		if (!open) {
+			fclose(file);
+			GfProfilingFreeSymbols(&symbols);
+			return false;
+		}
+
+		size_t depth = 0;
+		uint64_t ns = 0;
+
+		for (size_t i = 0; i < count; i++) {
+			GfProfilingEntry *entry = GfProfilingThreadEntry(thread, i);
+			bool exiting = entry->timeStamp >> 63;
+			ns = timer_ticks_to_ns((entry->timeStamp & ~(1ULL << 63)) - origin);
+
+			if (!exiting) {
+				open[depth].thisFunction = entry->thisFunction;
+				open[depth].timeStamp = ns;
+				depth++;
+			} else if (depth) {
+				depth--;
+				GfProfilingWriteCall(file, &symbols, processId, thread->threadId, open[depth].thisFunction, open[depth].timeStamp, ns);
+			}
+		}
+
+		while (depth) {
+			depth--;
+			GfProfilingWriteCall(file, &symbols, processId, thread->threadId, open[depth].thisFunction, open[depth].timeStamp, ns);
+		}
+
+		free(open);
+	}
+
+	fprintf(file, "\n]}\n");
+
+	GfProfilingFreeSymbols(&symbols);
+	return fclose(file) == 0;
+}
+
+// -----------------------------------------
+
 __attribute__((constructor)) 
 __attribute__((no_instrument_function))
 void GfProfilingInitialise() {
-	gfProfilingBufferSize = GF_PROFILING_BUFFER_BYTES / sizeof(GfProfilingEntry);
-	gfProfilingBuffer = (GfProfilingEntry *) malloc(GF_PROFILING_BUFFER_BYTES);
-	gfProfilingTicksPerMs = 1000000;
-	assert(gfProfilingBufferSize && gfProfilingBuffer);
+	static_assert((GF_PROFILING_THREAD_BUFFER_BYTES & (GF_PROFILING_THREAD_BUFFER_BYTES - 1)) == 0,
+	              "GF_PROFILING_THREAD_BUFFER_BYTES must be a power of two");
+	gfProfilingBufferSize = GF_PROFILING_THREAD_BUFFER_BYTES / sizeof(GfProfilingEntry);
+	timer_init();
+	gfProfilingTicksPerMs = timer_state.frequency / 1000;
+	assert(gfProfilingBufferSize);
 }
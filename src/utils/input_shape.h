@@ -0,0 +1,103 @@
+#ifndef INPUT_SHAPE_H
+#define INPUT_SHAPE_H
+
+/*
+ * Shape of a puzzle input: how many lines, how long they are and how they are split
+ * into sections (blocks separated by blank lines).
+ *
+ * The runner detects the shape once when the input is loaded, so the solutions can
+ * size their data from it instead of hard-coding the size of the puzzle input. The
+ * usual pattern is a kernel specialized for the shape of the puzzle inputs (so the
+ * compiler sees the sizes as constants) and a generic fallback for any other shape:
+ *
+ *     if (shape->line_length == 100) p1_kernel(ctx, 100, shape->line_count);
+ *     else                           p1_kernel(ctx, shape->line_length, shape->line_count);
+ *
+ * with p1_kernel declared force_inline.
+ *
+ * Windows line endings are accepted: line_length never counts the '\r', and kernels
+ * that index the input by rows step line_length + line_ending_length chars per line.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "string_utils.h"
+#include "typedefs.h"
+
+/* Sections whose line counts are recorded, later sections are only counted */
+#ifndef INPUT_SHAPE_MAX_SECTIONS
+#define INPUT_SHAPE_MAX_SECTIONS 4
+#endif /* ifndef INPUT_SHAPE_MAX_SECTIONS */
+
+typedef struct {
+    /* Lines, blank ones included (a final line without '\n' also counts) */
+    size_t line_count;
+    /* Length of the first line and of the longest one, without the line ending */
+    size_t line_length;
+    size_t max_line_length;
+    /* Chars after the content of the first line: 1 for "\n", 2 for "\r\n" */
+    size_t line_ending_length;
+    /* Every non blank line is line_length long, and every line ends like the first one */
+    bool   uniform;
+    /* Blocks of non blank lines separated by blank lines */
+    size_t section_count;
+    /* Non blank lines in each of the first sections */
+    size_t section_lines[INPUT_SHAPE_MAX_SECTIONS];
+} input_shape_t;
+
+/* Detects the shape of the input in a single pass over its lines */
+internal input_shape_t input_shape_detect(string_t input);
+
+internal input_shape_t input_shape_detect(string_t input) {
+
+    input_shape_t shape = { .uniform = true, .line_ending_length = 1 };
+
+    const char *chars = input.chars;
+    size_t      left  = input.count;
+    bool        in_section = false;
+
+    while (left > 0) {
+        const char *newline = memchr(chars, '\n', left);
+        size_t length = newline ? (size_t)(newline - chars) : left;
+
+        /* Tolerate Windows line endings */
+        size_t content_length = length;
+        if (content_length > 0 && chars[content_length - 1] == '\r') --content_length;
+
+        /* The last line may have no line ending at all */
+        size_t ending_length = length - content_length + 1;
+        if (shape.line_count == 0) {
+            shape.line_length        = content_length;
+            shape.line_ending_length = ending_length;
+        } else if (newline && ending_length != shape.line_ending_length) {
+            shape.uniform = false;
+        }
+        if (content_length > shape.max_line_length) shape.max_line_length = content_length;
+        ++shape.line_count;
+
+        if (content_length == 0) {
+            in_section = false;
+        } else {
+            if (content_length != shape.line_length) shape.uniform = false;
+
+            if (!in_section) {
+                in_section = true;
+                ++shape.section_count;
+            }
+            if (shape.section_count <= INPUT_SHAPE_MAX_SECTIONS) {
+                ++shape.section_lines[shape.section_count - 1];
+            }
+        }
+
+        if (!newline) break;
+
+        chars += length + 1;
+        left  -= length + 1;
+    }
+
+    return shape;
+}
+
+#endif /* ifndef INPUT_SHAPE_H */
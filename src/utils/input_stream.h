@@ -0,0 +1,240 @@
+#ifndef INPUT_STREAM_H
+#define INPUT_STREAM_H
+
+/*
+ * Pipelined input loading: a reader thread reads the file in fixed-size pieces while
+ * the parsers already consume the lines that arrived.
+ *
+ * The file is read into a single buffer (sized with fstat), so the parsers still see
+ * the input as one contiguous string and the lines never need to be copied. What the
+ * parsers get are chunks: chunk i has the lines that start in the bytes
+ * [i * INPUT_STREAM_CHUNK_SIZE, (i + 1) * INPUT_STREAM_CHUNK_SIZE). A chunk only has
+ * complete lines, so getting one may wait until the end of its last line is read.
+ *
+ * The same chunks can be taken from an input that is already loaded (stream == NULL),
+ * so parsers written against chunks work whether the input is streamed or not.
+ *
+ *     input_stream_t stream;
+ *     input_stream_open(&stream, "inputs/day_01.txt", allocator);
+ *     input_stream_start(&stream);
+ *
+ *     string_t chunk;
+ *     for (size_t i = 0; input_stream_chunk(&stream, stream_input, i, &chunk); ++i) ...
+ *
+ *     input_stream_join(&stream);
+ */
+
+#include <fcntl.h>
+#include <immintrin.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "allocator.h"
+#include "futex.h"
+#include "string_utils.h"
+#include "timer.h"
+#include "typedefs.h"
+
+/* Bytes per read, and bytes of line starts per chunk */
+#ifndef INPUT_STREAM_CHUNK_SIZE
+#define INPUT_STREAM_CHUNK_SIZE (16 * 1024)
+#endif /* ifndef INPUT_STREAM_CHUNK_SIZE */
+
+/* How many times to check for new data before sleeping on the futex */
+#ifndef INPUT_STREAM_SPIN_COUNT
+#define INPUT_STREAM_SPIN_COUNT 1024
+#endif /* ifndef INPUT_STREAM_SPIN_COUNT */
+
+typedef struct {
+    /* Bytes read so far, written only by the reader thread */
+    alignas(64) atomic_size_t loaded;
+    /* Bumped after every read, the parsers waiting for data sleep on it */
+    atomic_uint_least32_t     progress;
+    atomic_uint_least32_t     waiters;
+
+    alignas(64)
+    char      *buffer;
+    size_t     size;
+    int        fd;
+    pthread_t  reader;
+    /* Time the reader thread took to read the whole file */
+    u64        load_ns;
+} input_stream_t;
+
+/*
+ * Opens the file and allocates a buffer for all of it, without reading anything yet.
+ *
+ * Returns:
+ *     false if the file could not be opened (or its size could not be read).
+ */
+internal bool input_stream_open(input_stream_t *stream, const char *path, const allocator_t *allocator);
+
+/* Starts the reader thread */
+internal void input_stream_start(input_stream_t *stream);
+
+/* Waits for the reader thread, the whole file is in the buffer afterwards */
+internal void input_stream_join(input_stream_t *stream);
+
+/* The whole input as a string, only read the chunks of it while it is being streamed */
+internal string_t input_stream_string(const input_stream_t *stream);
+
+/*
+ * Gets chunk chunk_idx, waiting for its lines to be read if needed. Chunks can be
+ * empty when a line is longer than a chunk.
+ *
+ * stream - Stream the input is being read by, or NULL if input is already loaded.
+ * input  - The whole input (see input_stream_string).
+ *
+ * Returns:
+ *     false if the chunk is past the end of the input.
+ */
+internal bool input_stream_chunk(input_stream_t *stream, string_t input, size_t chunk_idx, string_t *chunk);
+
+internal void *input_stream_read_all(void *arg) {
+
+    input_stream_t *stream = arg;
+
+    u64 clock_start = timer_ticks();
+
+    size_t loaded = 0;
+    while (loaded < stream->size) {
+        size_t  to_read = stream->size - loaded;
+        if (to_read > INPUT_STREAM_CHUNK_SIZE) to_read = INPUT_STREAM_CHUNK_SIZE;
+
+        ssize_t bytes = read(stream->fd, stream->buffer + loaded, to_read);
+        if (bytes <= 0) {
+            /* The parsers rely on the size from fstat, there is no way to recover */
+            fprintf(stderr, "Input file changed or could not be read while streaming it\n");
+            exit(1);
+        }
+
+        loaded += bytes;
+        atomic_store_explicit(&stream->loaded, loaded, memory_order_release);
+        atomic_fetch_add_explicit(&stream->progress, 1, memory_order_seq_cst);
+
+        if (atomic_load_explicit(&stream->waiters, memory_order_seq_cst) > 0) {
+            futex_wake(&stream->progress, INT_MAX);
+        }
+    }
+
+    close(stream->fd);
+
+    stream->load_ns = timer_ticks_to_ns(timer_ticks_end() - clock_start);
+
+    return NULL;
+}
+
+internal bool input_stream_open(input_stream_t *stream, const char *path, const allocator_t *allocator) {
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        return false;
+    }
+
+    atomic_init(&stream->loaded, 0);
+    atomic_init(&stream->progress, 0);
+    atomic_init(&stream->waiters, 0);
+
+    stream->fd      = fd;
+    stream->size    = file_stat.st_size;
+    stream->buffer  = allocator_alloc(allocator, stream->size + 1);
+    stream->load_ns = 0;
+
+    if (stream->buffer == NULL) {
+        close(fd);
+        stream->fd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+internal void input_stream_start(input_stream_t *stream) {
+    int result = pthread_create(&stream->reader, NULL, input_stream_read_all, stream);
+    if (result != 0) {
+        fprintf(stderr, "Could not start the input reader thread\n");
+        exit(1);
+    }
+}
+
+internal void input_stream_join(input_stream_t *stream) {
+    pthread_join(stream->reader, NULL);
+}
+
+internal string_t input_stream_string(const input_stream_t *stream) {
+    return (string_t) { .chars = stream->buffer, .count = stream->size };
+}
+
+/* Waits until more than offset bytes are loaded, returns how many are */
+internal size_t input_stream_wait(input_stream_t *stream, size_t offset) {
+
+    size_t loaded = atomic_load_explicit(&stream->loaded, memory_order_acquire);
+
+    for (u32 spin = 0; loaded <= offset && spin < INPUT_STREAM_SPIN_COUNT; ++spin) {
+        _mm_pause();
+        loaded = atomic_load_explicit(&stream->loaded, memory_order_acquire);
+    }
+
+    while (loaded <= offset) {
+        u32 progress = atomic_load_explicit(&stream->progress, memory_order_seq_cst);
+        atomic_fetch_add_explicit(&stream->waiters, 1, memory_order_seq_cst);
+
+        /* Recheck after announcing that we are going to sleep, otherwise we could miss the wake up */
+        loaded = atomic_load_explicit(&stream->loaded, memory_order_acquire);
+        if (loaded <= offset) futex_wait(&stream->progress, progress);
+
+        atomic_fetch_sub_explicit(&stream->waiters, 1, memory_order_relaxed);
+        loaded = atomic_load_explicit(&stream->loaded, memory_order_acquire);
+    }
+
+    return loaded;
+}
+
+/* Start of the first line that starts at or after pos */
+internal size_t input_stream_line_start(input_stream_t *stream, string_t input, size_t pos) {
+
+    if (pos == 0)           return 0;
+    if (pos >= input.count) return input.count;
+
+    /* The line starts right after the first '\n' at or after pos - 1 */
+    size_t scan   = pos - 1;
+    size_t loaded = stream ? atomic_load_explicit(&stream->loaded, memory_order_acquire) : input.count;
+
+    for (;;) {
+        if (scan >= loaded) loaded = input_stream_wait(stream, scan);
+
+        const char *newline = memchr(input.chars + scan, '\n', loaded - scan);
+        if (newline) return (size_t)(newline - input.chars) + 1;
+
+        scan = loaded;
+        if (scan >= input.count) return input.count;
+    }
+}
+
+internal bool input_stream_chunk(input_stream_t *stream, string_t input, size_t chunk_idx, string_t *chunk) {
+
+    size_t begin = chunk_idx * INPUT_STREAM_CHUNK_SIZE;
+    if (begin >= input.count) return false;
+
+    size_t start = input_stream_line_start(stream, input, begin);
+    size_t end   = input_stream_line_start(stream, input, begin + INPUT_STREAM_CHUNK_SIZE);
+
+    *chunk = (string_t) { .chars = input.chars + start, .count = end - start };
+
+    return true;
+}
+
+#endif /* ifndef INPUT_STREAM_H */
@@ -5,9 +5,11 @@
 #if defined(__GNUC__) && (__GNUC__ >= 3)
 # define likely(x)   __builtin_expect(!!(x), 1)
 # define unlikely(x) __builtin_expect(!!(x), 0)
+# define force_inline inline __attribute__((always_inline))
 #else
 # define likely(x)   (x)
 # define unlikely(x) (x)
+# define force_inline inline
 #endif
 
 /* Useful macros for protyping unfinished code. */
@@ -26,8 +28,9 @@
 /* Align x up to a multiple of n where n is a power of 2 */
 #define ALIGN_POW_2(x, n) (( (x) + ( (n) - 1 )) & ~( (n) - 1 ))
 
-#define PROF_START(x) { const char *section = (x); uint64_t __clock_start = now_ns();
-#define PROF_END(label)  uint64_t __clock_end = now_ns(); printf("%s: %s took: %'ld ns\n", label, section, __clock_end - __clock_start);}
+/* Times the code in between with timer.h, which has to be included where they are used */
+#define PROF_START(x) { const char *section = (x); uint64_t __clock_start = timer_ticks();
+#define PROF_END(label)  uint64_t __clock_end = timer_ticks_end(); printf("%s: %s took: %'ld ns\n", label, section, timer_ticks_to_ns(__clock_end - __clock_start));}
 
 #define max(a, b) ((a) > (b)) ? (a) : (b)
 #define min(a, b) ((a) < (b)) ? (a) : (b)
@@ -0,0 +1,209 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+/*
+ * Parallel loops over [0, count) where items may have very different costs.
+ *
+ * Each item has a weight (its expected cost), given as prefix sums (see
+ * split_weights_evenly) or computed from a cost function with parallel_for_prefix.
+ * Without weights every item costs the same.
+ *
+ * PARALLEL_STATIC gives each thread one contiguous chunk with the same total weight,
+ * PARALLEL_DYNAMIC lets the threads claim smaller contiguous chunks from a shared
+ * cursor until there is nothing left, which also absorbs errors in the cost model.
+ *
+ * One thread initializes the loop, then (after a barrier) every thread iterates:
+ *
+ *     if (thread_idx == 0) parallel_for_init(&data.loop, PARALLEL_DYNAMIC, count, data.prefix, 1, thread_count);
+ *     sync_all(ctx);
+ *
+ *     size_t start, end;
+ *     parallel_for_iter_t it = parallel_for_begin(&data.loop, thread_idx);
+ *     while (parallel_for_next(&it, &start, &end)) {
+ *         for (size_t i = start; i < end; ++i) ...
+ *     }
+ */
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "macros.h"
+#include "splits.h"
+#include "typedefs.h"
+
+/* Dynamic chunks target 1 / (thread_count * PARALLEL_FOR_CHUNKS_PER_THREAD) of the total weight */
+#ifndef PARALLEL_FOR_CHUNKS_PER_THREAD
+#define PARALLEL_FOR_CHUNKS_PER_THREAD 8
+#endif /* ifndef PARALLEL_FOR_CHUNKS_PER_THREAD */
+
+enum parallel_schedule {
+    PARALLEL_STATIC = 0,
+    PARALLEL_DYNAMIC,
+};
+
+typedef struct {
+    /* Next unclaimed item (dynamic schedule), alone in its cache line since every thread updates it */
+    alignas(64) atomic_size_t next;
+
+    alignas(64)
+    enum parallel_schedule schedule;
+    size_t     count;
+    /* Prefix sums of the weights (count + 1 entries), NULL if all items cost the same */
+    const u64 *prefix;
+    /* Chunks have at least this many items, and static chunks start at multiples of it */
+    size_t     grain;
+    size_t     thread_count;
+    /* Weight of a dynamic chunk */
+    u64        chunk_weight;
+} parallel_for_t;
+
+/* Per thread iteration state */
+typedef struct {
+    parallel_for_t *loop;
+    size_t          thread_idx;
+    bool            done;
+} parallel_for_iter_t;
+
+/* Body of a loop, called with each chunk [start, end) */
+typedef void (*parallel_for_body_fn)(void *arg, size_t start, size_t end);
+
+/* Expected cost of the item idx */
+typedef u64 (*parallel_cost_fn)(void *arg, size_t idx);
+
+/*
+ * Prepares the loop. Must be called by a single thread, before the others start iterating.
+ *
+ * schedule     - PARALLEL_STATIC or PARALLEL_DYNAMIC.
+ * count        - Number of items.
+ * prefix       - Prefix sums of the weights (count + 1 entries) or NULL for equal weights.
+ *                Must stay valid while the loop runs.
+ * grain        - Minimum number of items per chunk (0 is the same as 1).
+ * thread_count - Threads taking part in the loop.
+ */
+internal void parallel_for_init(parallel_for_t *loop, enum parallel_schedule schedule,
+        size_t count, const u64 *prefix, size_t grain, size_t thread_count);
+
+/* Fills prefix (count + 1 entries) with the prefix sums of cost(arg, i). Returns the total weight. */
+internal u64 parallel_for_prefix(parallel_cost_fn cost, void *arg, size_t count, u64 *prefix);
+
+internal parallel_for_iter_t parallel_for_begin(parallel_for_t *loop, size_t thread_idx);
+
+/*
+ * Gets the next chunk [start, end) for the thread.
+ *
+ * Returns:
+ *     false when the thread has no more work.
+ */
+internal bool parallel_for_next(parallel_for_iter_t *it, size_t *start, size_t *end);
+
+/* Calls body with every chunk the thread gets */
+internal void parallel_for_run(parallel_for_t *loop, size_t thread_idx, parallel_for_body_fn body, void *arg);
+
+internal inline u64 parallel_for_weight(const parallel_for_t *loop, size_t idx) {
+    return loop->prefix ? loop->prefix[idx] : idx;
+}
+
+/* First item boundary where the accumulated weight reaches target */
+internal inline size_t parallel_for_find(const parallel_for_t *loop, u64 target) {
+    if (!loop->prefix) return target < loop->count ? target : loop->count;
+    return split_find_weight(loop->prefix, loop->count, target);
+}
+
+internal void parallel_for_init(parallel_for_t *loop, enum parallel_schedule schedule,
+        size_t count, const u64 *prefix, size_t grain, size_t thread_count) {
+
+    atomic_store_explicit(&loop->next, 0, memory_order_relaxed);
+
+    loop->schedule     = schedule;
+    loop->count        = count;
+    loop->prefix       = prefix;
+    loop->grain        = grain > 0 ? grain : 1;
+    loop->thread_count = thread_count > 0 ? thread_count : 1;
+
+    u64 chunk_count    = loop->thread_count * PARALLEL_FOR_CHUNKS_PER_THREAD;
+    loop->chunk_weight = parallel_for_weight(loop, count) / chunk_count;
+    if (loop->chunk_weight == 0) loop->chunk_weight = 1;
+}
+
+internal u64 parallel_for_prefix(parallel_cost_fn cost, void *arg, size_t count, u64 *prefix) {
+
+    prefix[0] = 0;
+    for (size_t i = 0; i < count; ++i) {
+        prefix[i + 1] = prefix[i] + cost(arg, i);
+    }
+
+    return prefix[count];
+}
+
+internal parallel_for_iter_t parallel_for_begin(parallel_for_t *loop, size_t thread_idx) {
+    return (parallel_for_iter_t) {
+        .loop       = loop,
+        .thread_idx = thread_idx,
+        .done       = false,
+    };
+}
+
+/* Rounds a static chunk boundary to the grain, the same way for both sides of the boundary */
+internal inline size_t parallel_for_align(const parallel_for_t *loop, size_t boundary) {
+    boundary = round_up(boundary, loop->grain);
+    return boundary < loop->count ? boundary : loop->count;
+}
+
+internal bool parallel_for_next(parallel_for_iter_t *it, size_t *start, size_t *end) {
+
+    parallel_for_t *loop = it->loop;
+
+    if (it->done) return false;
+
+    if (loop->schedule == PARALLEL_STATIC) {
+        it->done = true;
+
+        if (loop->prefix) {
+            split_weights_evenly(it->thread_idx, loop->thread_count, loop->prefix, loop->count, start, end);
+        } else {
+            split_count_evenly(it->thread_idx, loop->thread_count, loop->count, start, end);
+        }
+
+        *start = parallel_for_align(loop, *start);
+        *end   = it->thread_idx == loop->thread_count - 1 ? loop->count : parallel_for_align(loop, *end);
+
+        return *start < *end;
+    }
+
+    size_t claimed = atomic_load_explicit(&loop->next, memory_order_relaxed);
+    size_t chunk_end;
+
+    do {
+        if (claimed >= loop->count) {
+            it->done = true;
+            return false;
+        }
+
+        chunk_end = parallel_for_find(loop, parallel_for_weight(loop, claimed) + loop->chunk_weight);
+
+        if (chunk_end < claimed + loop->grain) chunk_end = claimed + loop->grain;
+        if (chunk_end > loop->count)           chunk_end = loop->count;
+
+    } while (!atomic_compare_exchange_weak_explicit(&loop->next, &claimed, chunk_end,
+                memory_order_relaxed, memory_order_relaxed));
+
+    *start = claimed;
+    *end   = chunk_end;
+
+    return true;
+}
+
+internal void parallel_for_run(parallel_for_t *loop, size_t thread_idx, parallel_for_body_fn body, void *arg) {
+
+    size_t start;
+    size_t end;
+
+    parallel_for_iter_t it = parallel_for_begin(loop, thread_idx);
+    while (parallel_for_next(&it, &start, &end)) {
+        body(arg, start, end);
+    }
+}
+
+#endif /* ifndef PARALLEL_FOR_H */
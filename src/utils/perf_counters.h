@@ -0,0 +1,175 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+/*
+ * Hardware performance counters of the calling thread, through perf_event_open.
+ *
+ * The counters are opened as one group, so a single read gets all of them at the same
+ * point. Only user space is counted, which perf_event_paranoid <= 2 allows for our own
+ * threads. Counters that can not be opened (no PMU in a VM, a stricter paranoid level,
+ * seccomp in a container) are simply missing from the samples, and when none can be
+ * opened perf_group_open returns false with the reason in group->error:
+ *
+ *     perf_group_t group;
+ *     if (perf_group_open(&group)) {
+ *         perf_sample_t before, after, delta;
+ *         perf_group_read(&group, &before);
+ *         ...
+ *         perf_group_read(&group, &after);
+ *         perf_sample_delta(&after, &before, &delta);
+ *     }
+ *     perf_group_close(&group);
+ */
+
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "typedefs.h"
+
+enum perf_counter {
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_BRANCH_MISSES,
+    /* Time the thread was running on a CPU, in ns */
+    PERF_TASK_CLOCK,
+    PERF_COUNTER_COUNT,
+};
+
+typedef struct {
+    /* First counter that could be opened, -1 if none */
+    int    leader;
+    int    fds[PERF_COUNTER_COUNT];
+    /* Counter of each value of a group read, in the order they were opened */
+    u32    order[PERF_COUNTER_COUNT];
+    u32    opened;
+    /* errno of the first counter that could not be opened */
+    int    error;
+} perf_group_t;
+
+typedef struct {
+    u64 values[PERF_COUNTER_COUNT];
+    /* Bit i is set if counter i was counted */
+    u32 available;
+} perf_sample_t;
+
+/*
+ * Opens every counter it can for the calling thread, counting from now on.
+ *
+ * Returns:
+ *     false if no counter could be opened.
+ */
+internal bool perf_group_open(perf_group_t *group);
+
+internal void perf_group_close(perf_group_t *group);
+
+/* Reads the current value of the counters, scaled up if the kernel had to multiplex them */
+internal bool perf_group_read(const perf_group_t *group, perf_sample_t *sample);
+
+/* Counts between two samples of the same group */
+internal void perf_sample_delta(const perf_sample_t *end, const perf_sample_t *start, perf_sample_t *delta);
+
+internal inline const char *perf_counter_name(enum perf_counter counter) {
+    switch (counter) {
+        case PERF_CYCLES:        return "cycles";
+        case PERF_INSTRUCTIONS:  return "instructions";
+        case PERF_CACHE_MISSES:  return "cache-misses";
+        case PERF_BRANCH_MISSES: return "branch-misses";
+        case PERF_TASK_CLOCK:    return "task-clock";
+        default:                 return "unknown";
+    }
+}
+
+internal inline bool perf_sample_has(const perf_sample_t *sample, enum perf_counter counter) {
+    return sample->available & (1u << counter);
+}
+
+internal bool perf_group_open(perf_group_t *group) {
+
+    static const struct { u32 type; u64 config; } events[PERF_COUNTER_COUNT] = {
+        [PERF_CYCLES]        = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        [PERF_INSTRUCTIONS]  = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        [PERF_CACHE_MISSES]  = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        [PERF_BRANCH_MISSES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        [PERF_TASK_CLOCK]    = { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+    };
+
+    group->leader = -1;
+    group->opened = 0;
+    group->error  = 0;
+
+    for (u32 i = 0; i < PERF_COUNTER_COUNT; ++i) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof (attr));
+        attr.size           = sizeof (attr);
+        attr.type           = events[i].type;
+        attr.config         = events[i].config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        /* pid 0 and cpu -1: the calling thread, on any CPU */
+        int fd = syscall(SYS_perf_event_open, &attr, 0, -1, group->leader, 0);
+        group->fds[i] = fd;
+
+        if (fd < 0) {
+            if (group->error == 0) group->error = errno;
+            continue;
+        }
+
+        if (group->leader < 0) group->leader = fd;
+        group->order[group->opened++] = i;
+    }
+
+    return group->leader >= 0;
+}
+
+internal void perf_group_close(perf_group_t *group) {
+    for (u32 i = 0; i < PERF_COUNTER_COUNT; ++i) {
+        if (group->fds[i] >= 0) close(group->fds[i]);
+        group->fds[i] = -1;
+    }
+    group->leader = -1;
+    group->opened = 0;
+}
+
+internal bool perf_group_read(const perf_group_t *group, perf_sample_t *sample) {
+
+    sample->available = 0;
+    if (group->leader < 0) return false;
+
+    /* nr, time enabled, time running, then one value per counter */
+    u64 data[3 + PERF_COUNTER_COUNT];
+    ssize_t size = read(group->leader, data, sizeof (data));
+    if (size < (ssize_t)(3 * sizeof (u64)) || data[0] != group->opened) return false;
+
+    u64 enabled = data[1];
+    u64 running = data[2];
+
+    for (u32 i = 0; i < group->opened; ++i) {
+        u64 value = data[3 + i];
+        /* The counters only ran part of the time, estimate the whole */
+        if (running > 0 && running < enabled) value = (u64)((double)value * enabled / running);
+
+        sample->values[group->order[i]] = value;
+        sample->available |= 1u << group->order[i];
+    }
+
+    return true;
+}
+
+internal void perf_sample_delta(const perf_sample_t *end, const perf_sample_t *start, perf_sample_t *delta) {
+
+    delta->available = end->available & start->available;
+
+    for (u32 i = 0; i < PERF_COUNTER_COUNT; ++i) {
+        delta->values[i] = (delta->available & (1u << i)) ? end->values[i] - start->values[i] : 0;
+    }
+}
+
+#endif /* ifndef PERF_COUNTERS_H */
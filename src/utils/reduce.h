@@ -0,0 +1,86 @@
+#ifndef REDUCE_H
+#define REDUCE_H
+
+/*
+ * Parallel reductions without shared atomics.
+ *
+ * Each thread accumulates its partial result in a local variable and publishes it
+ * once to its own slot. The slots are padded to a cache line, so threads storing
+ * their results never invalidate each other's lines (or the lines of the data they
+ * are reading). After a barrier, any thread can combine the slots.
+ *
+ *     u64 local_sum = 0;
+ *     for (...) local_sum += ...;
+ *     reduce_store(&reduction, thread_idx, local_sum);
+ *
+ *     sync_all(ctx);
+ *
+ *     u64 total = reduce_sum(&reduction, thread_count);
+ *
+ * Values are u64; signed values can be stored as their two's complement for sums,
+ * or combined with a custom operation.
+ */
+
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "typedefs.h"
+
+#ifndef REDUCE_MAX_THREADS
+#define REDUCE_MAX_THREADS 64
+#endif /* ifndef REDUCE_MAX_THREADS */
+
+typedef struct {
+    alignas(64) u64 value;
+} reduce_slot_t;
+
+typedef struct {
+    reduce_slot_t slots[REDUCE_MAX_THREADS];
+} reduction_t;
+
+/* Combines two partial results, must be associative */
+typedef u64 (*reduce_op_fn)(u64 acc, u64 value);
+
+/* Publishes the partial result of a thread */
+internal inline void reduce_store(reduction_t *reduction, size_t thread_idx, u64 value) {
+    reduction->slots[thread_idx].value = value;
+}
+
+/*
+ * Combines the partial results of the first thread_count threads, in thread order.
+ * Only call it after a barrier that every thread reached after storing its result.
+ *
+ * identity - Result when there are no threads (e.g. 0 for sums, UINT64_MAX for min).
+ */
+internal inline u64 reduce_combine(const reduction_t *reduction, size_t thread_count, reduce_op_fn op, u64 identity) {
+    u64 acc = identity;
+    for (size_t i = 0; i < thread_count; ++i) {
+        acc = op(acc, reduction->slots[i].value);
+    }
+    return acc;
+}
+
+internal inline u64 reduce_sum(const reduction_t *reduction, size_t thread_count) {
+    u64 acc = 0;
+    for (size_t i = 0; i < thread_count; ++i) acc += reduction->slots[i].value;
+    return acc;
+}
+
+internal inline u64 reduce_min(const reduction_t *reduction, size_t thread_count) {
+    u64 acc = UINT64_MAX;
+    for (size_t i = 0; i < thread_count; ++i) {
+        if (reduction->slots[i].value < acc) acc = reduction->slots[i].value;
+    }
+    return acc;
+}
+
+internal inline u64 reduce_max(const reduction_t *reduction, size_t thread_count) {
+    u64 acc = 0;
+    for (size_t i = 0; i < thread_count; ++i) {
+        if (reduction->slots[i].value > acc) acc = reduction->slots[i].value;
+    }
+    return acc;
+}
+
+#endif /* ifndef REDUCE_H */
@@ -0,0 +1,1638 @@
+#ifndef RUNNER_H
+#define RUNNER_H
+
+/*
+ * Runtime shared by the solutions of every day.
+ *
+ * A day only provides the solve function of each part (and the data shared by its
+ * threads), everything else is done by the runner: reading the input, the arenas,
+ * the worker threads (pool, pinning and thread counts), barriers, benchmarks and autotuning.
+ *
+ *     static runner_day_t day = {
+ *         .number = 2,
+ *         .parts  = {
+ *             RUNNER_PART(p1_solve, p1, P1_THREADS, P1_BARRIER),
+ *             RUNNER_PART(p2_solve, p2, P2_THREADS, P2_BARRIER),
+ *         },
+ *     };
+ *
+ *     int main(int argc, char **argv) {
+ *         return runner_main(&day, argc, argv);
+ *     }
+ *
+ * Parts can mark where their phases start with part_phase (setup, compute, finalize),
+ * the benchmarks then report how long each phase takes:
+ *
+ *     if (thread_idx == 0) p1_setup(ctx);
+ *     sync_all(ctx);
+ *
+ *     part_phase(ctx, PHASE_COMPUTE);
+ *     ...
+ *     part_phase(ctx, PHASE_FINALIZE);
+ *
+ * Parts that read their input with part_input_next (instead of ctx->common->input)
+ * can be declared with RUNNER_STREAMING_PART. Running the day with --stream then
+ * starts them while the input is still being read (see input_stream.h).
+ *
+ * The implementation is only included when RUNNER_IMPL is defined.
+ *
+ * Thread pinning requires _GNU_SOURCE to be defined before any system header.
+ */
+
+#include <assert.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <locale.h>
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "allocator.h"
+#include "autotune.h"
+#include "barrier.h"
+#include "bench.h"
+#include "cache_evict.h"
+#include "input_shape.h"
+#include "input_stream.h"
+#include "macros.h"
+#include "perf_counters.h"
+#include "reduce.h"
+#include "string_utils.h"
+#include "thread_pool.h"
+#include "timer.h"
+#include "topology.h"
+#include "typedefs.h"
+#include "unix_socket.h"
+
+/* Most threads a part can run with */
+#ifndef RUNNER_MAX_THREADS
+#define RUNNER_MAX_THREADS 32
+#endif /* ifndef RUNNER_MAX_THREADS */
+
+/* Size of the buffer the inputs are read into */
+#ifndef RUNNER_FILE_CAP
+#define RUNNER_FILE_CAP (100 * 8 * 1024)
+#endif /* ifndef RUNNER_FILE_CAP */
+
+/*
+ * RUNNER_STARTUP_PROFILE builds for the time from exec to the answers (see
+ * tools/startup_latency.c) instead of for the benchmarks: numbers are printed without
+ * loading the pt_BR locale, and the arenas are faulted in with a single madvise before
+ * they are used, instead of one page fault at a time while the parts run.
+ */
+#ifdef RUNNER_STARTUP_PROFILE
+/* Bytes of the solution arena that are faulted in by runner_init */
+#ifndef RUNNER_PREFAULT_SIZE
+#define RUNNER_PREFAULT_SIZE (64 * 1024)
+#endif /* ifndef RUNNER_PREFAULT_SIZE */
+#endif /* ifdef RUNNER_STARTUP_PROFILE */
+
+/* How to pin the threads of each part (can be overridden with AOC_PIN_POLICY) */
+#ifndef PIN_POLICY
+#define PIN_POLICY PIN_PHYSICAL_FIRST
+#endif /* ifndef PIN_POLICY */
+
+/* Compiler flags the day was built with, recorded with the benchmark results */
+#ifndef RUNNER_BUILD_FLAGS
+#define RUNNER_BUILD_FLAGS "unknown"
+#endif /* ifndef RUNNER_BUILD_FLAGS */
+
+#define RUNNER_PART_COUNT 2
+
+/* Most measured runs of each mode in runner_cold_benchmark, evicting the caches takes a while */
+#ifndef RUNNER_COLD_MAX_RUNS
+#define RUNNER_COLD_MAX_RUNS 50
+#endif /* ifndef RUNNER_COLD_MAX_RUNS */
+
+/* Message size that asks the daemon to exit */
+#define RUNNER_DAEMON_STOP UINT64_MAX
+
+_Static_assert(RUNNER_MAX_THREADS <= REDUCE_MAX_THREADS, "Not enough reduction slots for every thread");
+
+/* Phases of a part, every thread starts in PHASE_SETUP */
+enum part_phase {
+    /* Parsing the input and preparing the shared data */
+    PHASE_SETUP = 0,
+    /* Solving */
+    PHASE_COMPUTE,
+    /* Combining the results and formatting the answer */
+    PHASE_FINALIZE,
+    PHASE_COUNT
+};
+
+/* Time spent by a thread in each phase, in a cache line of its own */
+typedef struct {
+    alignas(64) u64 elapsed[PHASE_COUNT];
+    /* Start of the current phase */
+    u64             mark;
+    enum part_phase current;
+} part_phase_clock_t;
+
+typedef void *(*part_solve_fn)(void *ctx);
+
+/* Infrastructure for each part */
+struct part_context_common {
+    enum barrier_type barrier_type;
+    spin_barrier_t    spin_barrier;
+    pthread_barrier_t barrier;
+    /* Partial results of each thread, see part_reduce_store */
+    reduction_t       reduction;
+    size_t            thread_count;
+    string_t          output;
+    string_t         *input;
+    /* Set while the input is being streamed, see part_input_next */
+    input_stream_t   *stream;
+    /* Next chunk of the input to hand out */
+    atomic_size_t    input_cursor;
+    /* Shape of the input, detected when it is loaded (not available while streaming) */
+    const input_shape_t *shape;
+    allocator_t      *arena;
+    void             *test_data;
+    bool             is_test;
+    /* Set while benchmarking, part_phase does nothing otherwise */
+    bool             time_phases;
+    /* Set while reading the performance counters of each thread */
+    bool             count_events;
+    part_solve_fn    solve;
+};
+
+struct part_context {
+    size_t thread_idx;
+    struct part_context_common *common;
+    part_phase_clock_t phases;
+    /* Counted by this thread in the last run (when count_events is set) */
+    perf_sample_t counters;
+};
+
+typedef struct {
+    /* Run by every thread of the part with its struct part_context */
+    part_solve_fn solve;
+    /* Data shared by the threads of the part, cleared before every run */
+    void         *data;
+    size_t        data_size;
+    /* Thread count used when the day has not been autotuned */
+    size_t        default_threads;
+    /* Barrier used by sync_all */
+    enum barrier_type barrier_type;
+    /* Only reads the input through part_input_next, so it can run while the input is streamed */
+    bool          streams_input;
+
+    /* Set up by the runner */
+    struct part_context_common common;
+    struct part_context        contexts[RUNNER_MAX_THREADS];
+} runner_part_t;
+
+typedef struct {
+    u32           number;
+    /* Fewest measured runs of each part in the benchmarks (0 to skip them), see bench.h */
+    size_t        benchmark_runs;
+    /* Parts without a solve function are skipped */
+    runner_part_t parts[RUNNER_PART_COUNT];
+    /* The parts need every line of the input to have the same length (they assert it) */
+    bool          uniform_input;
+
+    /* Set up by the runner */
+    string_t      input;
+    input_shape_t shape;
+} runner_day_t;
+
+/* Describes a part, shared_data is the (static) variable with the data shared by its threads */
+#define RUNNER_PART(solve_fn, shared_data, thread_count, barrier) {  \
+        .solve           = (solve_fn),                               \
+        .data            = &(shared_data),                           \
+        .data_size       = sizeof (shared_data),                     \
+        .default_threads = (thread_count),                           \
+        .barrier_type    = (barrier),                                \
+    }
+
+#define RUNNER_STREAMING_PART(solve_fn, shared_data, thread_count, barrier) {  \
+        .solve           = (solve_fn),                                         \
+        .data            = &(shared_data),                                     \
+        .data_size       = sizeof (shared_data),                               \
+        .default_threads = (thread_count),                                     \
+        .barrier_type    = (barrier),                                          \
+        .streams_input   = true,                                               \
+    }
+
+/* Common utilities */
+internal inline u64 now_ns(void) {
+    return timer_now_ns();
+}
+
+/*
+ * Ends the current phase of the calling thread and starts the given one. Time spent
+ * waiting in a barrier counts for the phase the thread is in, so call it after the
+ * barrier that ends the previous phase.
+ */
+internal inline void part_phase(struct part_context *ctx, enum part_phase phase) {
+    if (!ctx->common->time_phases) return;
+
+    u64 now = now_ns();
+    ctx->phases.elapsed[ctx->phases.current] += now - ctx->phases.mark;
+    ctx->phases.current = phase;
+    ctx->phases.mark    = now;
+}
+
+internal inline void sync_all(struct part_context *ctx) {
+    struct part_context_common *common = ctx->common;
+
+    if (common->thread_count <= 1) return;
+
+    if (common->barrier_type == BARRIER_SPIN) {
+        spin_barrier_wait(&common->spin_barrier);
+    } else {
+        pthread_barrier_wait(&common->barrier);
+    }
+}
+
+/*
+ * Gets the next chunk of complete lines of the input, waiting for it if the input is
+ * still being streamed. The chunks are handed out in order, each one to a single
+ * thread of the part.
+ *
+ * Returns:
+ *     false when the whole input was handed out.
+ */
+internal inline bool part_input_next(struct part_context *ctx, string_t *chunk) {
+    struct part_context_common *common = ctx->common;
+
+    for (;;) {
+        size_t chunk_idx = atomic_fetch_add_explicit(&common->input_cursor, 1, memory_order_relaxed);
+        if (!input_stream_chunk(common->stream, *common->input, chunk_idx, chunk)) return false;
+
+        /* Chunks are empty when a line is longer than a chunk */
+        if (chunk->count > 0) return true;
+    }
+}
+
+/* Publishes the partial result of the calling thread, without touching any shared cache line */
+internal inline void part_reduce_store(struct part_context *ctx, u64 value) {
+    reduce_store(&ctx->common->reduction, ctx->thread_idx, value);
+}
+
+/* Combined results of every thread of the part, only valid after a sync_all that follows the stores */
+internal inline u64 part_reduce_sum(struct part_context *ctx) {
+    return reduce_sum(&ctx->common->reduction, ctx->common->thread_count);
+}
+
+internal inline u64 part_reduce_min(struct part_context *ctx) {
+    return reduce_min(&ctx->common->reduction, ctx->common->thread_count);
+}
+
+internal inline u64 part_reduce_max(struct part_context *ctx) {
+    return reduce_max(&ctx->common->reduction, ctx->common->thread_count);
+}
+
+internal inline u64 part_reduce(struct part_context *ctx, reduce_op_fn op, u64 identity) {
+    return reduce_combine(&ctx->common->reduction, ctx->common->thread_count, op, identity);
+}
+
+/*
+ * Runs a day: prints the answer of each part, then the benchmarks. With --autotune
+ * as the first argument, the thread counts of the day are tuned instead. With --stream,
+ * the streaming parts run while the input is being read. With --batch followed by
+ * directories or files, the day is run over every one of those inputs (see runner_batch).
+ * --daemon and --client talk to a resident process instead (see runner_daemon).
+ *
+ * Returns:
+ *     The exit code of the program.
+ */
+internal int runner_main(runner_day_t *day, int argc, char **argv);
+
+/* Sets up the locale, the arenas used by the solutions and the buffer for the inputs */
+internal void runner_init(void);
+
+/*
+ * Reads the input of the day, detects its shape and sets up its parts with the tuned thread counts
+ * (or the default ones if the day was not tuned). The barrier of every part can be
+ * overridden with the AOC_BARRIER environment variable (see barrier_type_names).
+ *
+ * Returns:
+ *     false if the input could not be read.
+ */
+internal bool runner_load_day(runner_day_t *day);
+
+/* Path of the usual input of the day, inputs/day_XX.txt relative to the working directory */
+internal void runner_input_path(u32 day_number, char *path, size_t path_size);
+
+/*
+ * Reads the file at path into the input buffer as the input of the day, and detects
+ * its shape. Does not touch the parts.
+ *
+ * Returns:
+ *     false if the file could not be read or does not fit in what is left of the buffer.
+ */
+internal bool runner_read_input(runner_day_t *day, const char *path);
+
+/*
+ * Checks the shape of the loaded input against what the parts of the day can solve, so
+ * --batch and --daemon reject it instead of failing an assertion in a part.
+ *
+ * Returns:
+ *     NULL when the parts can solve it, the reason otherwise.
+ */
+internal const char *runner_check_input(const runner_day_t *day);
+
+/*
+ * Like runner_load_day, but the input is only opened: input_stream_start starts reading
+ * it, and runner_finish_stream waits until it is read (then the shape is available).
+ */
+internal bool runner_open_stream(runner_day_t *day, input_stream_t *stream);
+
+internal void runner_finish_stream(runner_day_t *day, input_stream_t *stream);
+
+/* Most threads worth running a part with: the online CPUs, up to RUNNER_MAX_THREADS */
+internal size_t runner_online_threads(void);
+
+/*
+ * Starts the worker threads and pins them (and the calling thread) according to the
+ * policy. The calling thread also runs tasks, so worker_count is the most threads
+ * a part will use minus one.
+ */
+internal void runner_start_pool(size_t worker_count);
+
+/* Changes how many threads run the part */
+internal void runner_set_thread_count(runner_part_t *part, size_t thread_count);
+
+/* Runs the part once, the answer is in part->common.output */
+internal void runner_run_part(runner_part_t *part);
+
+/*
+ * Benchmarks the part (see bench.h, at least day->benchmark_runs measured runs) and
+ * prints the distribution of its times, then min/median/max of each phase (the slowest
+ * thread of each run).
+ */
+internal void runner_benchmark_part(runner_day_t *day, size_t part_idx);
+
+/* How the caches are before each run of runner_cold_benchmark */
+enum runner_cache_mode {
+    /* Whatever the previous run left in them */
+    CACHE_WARM = 0,
+    /* Evicted, the input and the data of the part are only in memory */
+    CACHE_COLD,
+    /* Evicted, and the input is read again (from the page cache) as part of the run */
+    CACHE_COLD_RELOAD,
+    CACHE_MODE_COUNT,
+};
+
+/*
+ * Benchmarks the part with warm caches, with evicted caches (see cache_evict.h) and
+ * with evicted caches while also reading the input again, and prints them side by side.
+ */
+internal void runner_cold_benchmark(runner_day_t *day, size_t part_idx);
+
+/*
+ * Appends the benchmark of a part to the file in AOC_RESULTS, if set: a CSV row if the
+ * file name ends in .csv (with a header if the file is new), otherwise a JSON object per
+ * line with every sample, which is what ./nob compare reads.
+ */
+internal void runner_record_results(runner_day_t *day, size_t part_idx, const bench_t *bench, const bench_stats_t *stats);
+
+/*
+ * Runs the part with the performance counters of every thread open (see perf_counters.h)
+ * and prints the counts per run, IPC and misses per input byte. Prints why instead
+ * when the counters are not available.
+ */
+internal void runner_count_part(runner_day_t *day, size_t part_idx);
+
+/* Tunes the thread count of every part and saves them to the tuning file of the day */
+internal void runner_autotune(runner_day_t *day);
+
+/*
+ * Benchmarks every part with each thread count from 1 to RUNNER_MAX_THREADS (limited by
+ * the online CPUs) and prints the median time, speedup and parallel efficiency of each.
+ *
+ * csv_path - If not NULL, the rows are also appended to this CSV file.
+ */
+internal void runner_scaling(runner_day_t *day, const char *csv_path);
+
+/*
+ * Runs every part of the day over each input (files, or every file in the given
+ * directories), reusing the arenas and the worker threads. Prints the answers for each
+ * input, then inputs/s, bytes/s and percentiles of the time per input.
+ *
+ * Returns:
+ *     The exit code of the program.
+ */
+internal int runner_batch(runner_day_t *day, int path_count, char **paths);
+
+/*
+ * Stays resident with the arenas and the worker threads ready, and solves the inputs
+ * sent to a Unix socket (/tmp/aoc_day_XX.sock, or the AOC_SOCKET environment variable).
+ * Each request is a message with the input, each response a message with the answer and
+ * the time of every part. A message of size RUNNER_DAEMON_STOP makes it exit.
+ *
+ * Returns:
+ *     The exit code of the program.
+ */
+internal int runner_daemon(runner_day_t *day);
+
+/*
+ * Sends each file to the daemon of the day and prints its responses, with the round
+ * trip time. A path of --stop stops the daemon instead.
+ *
+ * Returns:
+ *     The exit code of the program.
+ */
+internal int runner_client(runner_day_t *day, int path_count, char **paths);
+
+/*
+ * Writes the calls recorded since runner_init to AOC_TRACE as a Chrome trace (the _dbg
+ * builds record every call with -finstrument-functions, see gf_profiling.c). Only the
+ * first call writes it: runner_main calls it before the benchmarks, and it runs at exit
+ * for the other modes. Does nothing in the other builds or without AOC_TRACE.
+ */
+internal void runner_trace_export(void);
+
+/*
+ * Calibrates the timer if nothing has read it yet and prints its source and rate. Called
+ * before the first measurements, not at startup, so the answers don't wait for it.
+ */
+internal void runner_print_timer(void);
+
+#ifdef RUNNER_IMPL
+
+#ifdef DEBUG_MODE
+#include "gf_profiling.c"
+
+global_var const char *runner_trace_path;
+#endif /* ifdef DEBUG_MODE */
+
+global_var const char *part_phase_names[PHASE_COUNT] = {
+    [PHASE_SETUP]    = "setup",
+    [PHASE_COMPUTE]  = "compute",
+    [PHASE_FINALIZE] = "finalize",
+};
+
+global_var unsigned char   runner_file_buffer[RUNNER_FILE_CAP];
+global_var allocator_t     runner_file_arena;
+global_var arena_context_t runner_solution_arena_ctx;
+global_var allocator_t     runner_solution_arena;
+
+global_var thread_pool_t   runner_pool;
+
+/* Performance counters of each thread, opened the first time it runs a counted part */
+global_var _Thread_local perf_group_t runner_perf_group;
+global_var _Thread_local bool         runner_perf_opened;
+global_var enum pin_policy runner_pin_policy;
+
+internal int runner_main(runner_day_t *day, int argc, char **argv) {
+
+    bool autotune  = argc > 1 && strcmp(argv[1], "--autotune") == 0;
+    bool streaming = argc > 1 && strcmp(argv[1], "--stream") == 0;
+    bool cold      = argc > 1 && strcmp(argv[1], "--cold") == 0;
+    bool scaling   = argc > 1 && strcmp(argv[1], "--scaling") == 0;
+
+    runner_init();
+
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0) {
+        return runner_batch(day, argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "--daemon") == 0) {
+        return runner_daemon(day);
+    }
+    if (argc > 1 && strcmp(argv[1], "--client") == 0) {
+        return runner_client(day, argc - 2, argv + 2);
+    }
+
+    input_stream_t stream;
+    bool loaded = streaming ? runner_open_stream(day, &stream) : runner_load_day(day);
+
+    if (!loaded) {
+        char path[64];
+        runner_input_path(day->number, path, sizeof (path));
+        fprintf(stderr, "Could not read %s\n", path);
+        return 1;
+    }
+
+    /* Before the pool pins this thread, so the reader can run on any CPU (and reads
+     * while the workers start) */
+    u64 stream_start = 0;
+    if (streaming) {
+        stream_start = now_ns();
+        input_stream_start(&stream);
+    }
+
+    /* Start the workers once, the calling thread also runs one of the tasks. Autotuning
+     * and scaling try every thread count up to the online CPUs */
+    size_t worker_count = runner_online_threads() - 1;
+    if (!autotune && !scaling) {
+        size_t max_threads = 1;
+        for (size_t i = 0; i < RUNNER_PART_COUNT; ++i) {
+            max_threads = (max(max_threads, day->parts[i].common.thread_count));
+        }
+        worker_count = max_threads - 1;
+    }
+    runner_start_pool(worker_count);
+
+    printf("\n==== Day %02u ====\n", day->number);
+    printf("Thread pinning: %s\n", pin_policy_names[runner_pin_policy]);
+    printf("Threads (part 1/part 2): %zu/%zu\n",
+            day->parts[0].common.thread_count, day->parts[1].common.thread_count);
+    printf("Barriers (part 1/part 2): %s/%s\n",
+            barrier_type_names[day->parts[0].common.barrier_type],
+            barrier_type_names[day->parts[1].common.barrier_type]);
+
+    if (autotune) {
+        runner_print_timer();
+        runner_autotune(day);
+        return 0;
+    }
+    if (scaling) {
+        runner_print_timer();
+        runner_scaling(day, argc > 2 ? argv[2] : NULL);
+        return 0;
+    }
+
+    for (size_t i = 0; i < RUNNER_PART_COUNT; ++i) {
+        runner_part_t *part = &day->parts[i];
+        if (!part->solve) continue;
+
+        /* Other parts need the whole input */
+        if (streaming && !part->streams_input) {
+            runner_finish_stream(day, &stream);
+            streaming = false;
+        }
+
+        printf("Solution to part %zu:\n", i + 1);
+        runner_run_part(part);
+        /* Only streamed runs are timed here, the timer calibrates on its first read */
+        u64 part_end = streaming ? now_ns() : 0;
+        string_println(&part->common.output);
+        /* Show the answer right away, even when stdout is a pipe */
+        fflush(stdout);
+
+        if (streaming) {
+            printf("Part %zu done %'lu ns after the input started loading\n", i + 1, part_end - stream_start);
+        }
+
+        arena_reset(runner_solution_arena.alloc_ctx);
+    }
+
+    if (streaming) runner_finish_stream(day, &stream);
+
+    /* The benchmark runs would overwrite the solve in the ring buffers */
+    runner_trace_export();
+
+    runner_print_timer();
+
+    for (size_t i = 0; i < RUNNER_PART_COUNT; ++i) {
+        if (!day->parts[i].solve) continue;
+
+        if (cold) {
+            runner_cold_benchmark(day, i);
+            continue;
+        }
+
+        runner_benchmark_part(day, i);
+        runner_count_part(day, i);
+    }
+
+    return 0;
+}
+
+internal void runner_print_timer(void) {
+    timer_init();
+    printf("Timer: %s (%.2f GHz)\n", timer_source_name(), timer_state.frequency / 1e9);
+}
+
+/* Faults in the whole pages of a buffer at once, falling back to touching each page */
+internal void runner_prefault(void *buffer, size_t size) {
+
+    uintptr_t page_size = sysconf(_SC_PAGESIZE);
+    uintptr_t begin     = round_up((uintptr_t)buffer, page_size);
+    uintptr_t end       = ((uintptr_t)buffer + size) & ~(page_size - 1);
+    if (end <= begin) return;
+
+#ifdef MADV_POPULATE_WRITE
+    if (madvise((void *)begin, end - begin, MADV_POPULATE_WRITE) == 0) return;
+#endif /* ifdef MADV_POPULATE_WRITE */
+
+    for (uintptr_t page = begin; page < end; page += page_size) {
+        *(volatile u8 *)page = 0;
+    }
+}
+
+internal void runner_init(void) {
+
+#ifndef RUNNER_STARTUP_PROFILE
+    setlocale(LC_NUMERIC, "pt_BR.UTF-8");
+#endif /* ifndef RUNNER_STARTUP_PROFILE */
+
+    runner_file_arena.alloc_ctx = arena_from_buf(runner_file_buffer, RUNNER_FILE_CAP);
+    runner_file_arena.interface = &arena_interface;
+
+    runner_solution_arena_ctx = arena_init(4096, ARENA_FAST_ALLOC | ARENA_GROWABLE | ARENA_VIRTUAL_BACKEND, NULL, NULL);
+    runner_solution_arena.alloc_ctx = &runner_solution_arena_ctx;
+    runner_solution_arena.interface = &arena_interface;
+
+#ifdef RUNNER_STARTUP_PROFILE
+    /* Commits the first pages of the arena, they stay committed after the reset */
+    runner_prefault(arena_alloc(&runner_solution_arena_ctx, RUNNER_PREFAULT_SIZE), RUNNER_PREFAULT_SIZE);
+    arena_reset(&runner_solution_arena_ctx);
+#endif /* ifdef RUNNER_STARTUP_PROFILE */
+
+#ifdef DEBUG_MODE
+    runner_trace_path = getenv("AOC_TRACE");
+    if (runner_trace_path) {
+        GfProfilingStart();
+        atexit(runner_trace_export);
+    }
+#endif /* ifdef DEBUG_MODE */
+}
+
+internal void runner_trace_export(void) {
+
+#ifdef DEBUG_MODE
+    if (!runner_trace_path) return;
+
+    const char *path = runner_trace_path;
+    runner_trace_path = NULL;
+    GfProfilingStop();
+
+    if (GfProfilingExportChromeTrace(path)) {
+        printf("Trace of %u threads written to %s\n", gfProfilingThreadCount, path);
+    } else {
+        fprintf(stderr, "Could not write the trace to %s\n", path);
+    }
+#endif /* ifdef DEBUG_MODE */
+}
+
+/* Sets up the parts of a day once its input is known (or at least its size) */
+internal void runner_setup_parts(runner_day_t *day) {
+
+    /* Thread counts: the defaults of each part unless there is a tuning file for this day */
+    tuning_t tuning = {
+        .p1_threads = day->parts[0].default_threads,
+        .p2_threads = day->parts[1].default_threads,
+        .input_size = day->input.count,
+    };
+    if (tuning_load(day->number, &tuning) && tuning.input_size != day->input.count) {
+        fprintf(stderr, "Tuning was done for a different input, run with --autotune again\n");
+    }
+
+    size_t thread_counts[RUNNER_PART_COUNT] = { tuning.p1_threads, tuning.p2_threads };
+
+    for (size_t i = 0; i < RUNNER_PART_COUNT; ++i) {
+        runner_part_t *part = &day->parts[i];
+
+        part->common.input        = &day->input;
+        part->common.shape        = &day->shape;
+        part->common.arena        = &runner_solution_arena;
+        part->common.barrier_type = barrier_type_from_env(part->barrier_type);
+        runner_set_thread_count(part, thread_counts[i]);
+    }
+}
+
+internal bool runner_read_input(runner_day_t *day, const char *path) {
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat file_stat;
+    char *buffer = NULL;
+    size_t size  = 0;
+
+    if (fstat(fd, &file_stat) == 0) {
+        size   = file_stat.st_size;
+        buffer = allocator_alloc(&runner_file_arena, size + 1);
+    }
+
+#ifdef RUNNER_STARTUP_PROFILE
+    if (buffer) runner_prefault(buffer, size + 1);
+#endif /* ifdef RUNNER_STARTUP_PROFILE */
+
+    size_t loaded = 0;
+    while (buffer && loaded < size) {
+        ssize_t bytes = read(fd, buffer + loaded, size - loaded);
+        if (bytes <= 0) break;
+        loaded += bytes;
+    }
+
+    close(fd);
+
+    if (!buffer || loaded < size) return false;
+
+    buffer[size] = '\0';
+    day->input   = (string_t) { .chars = buffer, .count = size };
+    day->shape   = input_shape_detect(day->input);
+
+    return true;
+}
+
+internal const char *runner_check_input(const runner_day_t *day) {
+
+    if (day->uniform_input && !day->shape.uniform) return "every line must have the same length";
+
+    return NULL;
+}
+
+internal void runner_input_path(u32 day_number, char *path, size_t path_size) {
+    snprintf(path, path_size, "inputs/day_%02u.txt", day_number);
+}
+
+internal bool runner_load_day(runner_day_t *day) {
+
+    char path[64];
+    runner_input_path(day->number, path, sizeof (path));
+
+    if (!runner_read_input(day, path)) return false;
+
+    runner_setup_parts(day);
+
+    return true;
+}
+
+internal bool runner_open_stream(runner_day_t *day, input_stream_t *stream) {
+
+    char path[64];
+    runner_input_path(day->number, path, sizeof (path));
+
+    if (!input_stream_open(stream, path, &runner_file_arena)) return false;
+
+    day->input = input_stream_string(stream);
+    day->shape = (input_shape_t) {0};
+
+    runner_setup_parts(day);
+
+    for (size_t i = 0; i < RUNNER_PART_COUNT; ++i) {
+        if (day->parts[i].streams_input) day->parts[i].common.stream = stream;
+    }
+
+    return true;
+}
+
+internal void runner_finish_stream(runner_day_t *day, input_stream_t *stream) {
+
+    input_stream_join(stream);
+    printf("Input streamed in %'lu ns (%zu bytes)\n", stream->load_ns, stream->size);
+
+    day->shape = input_shape_detect(day->input);
+
+    for (size_t i = 0; i < RUNNER_PART_COUNT; ++i) {
+        day->parts[i].common.stream = NULL;
+    }
+}
+
+internal size_t runner_online_threads(void) {
+    long online_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return (min((size_t)(online_cpus > 0 ? online_cpus : 1), RUNNER_MAX_THREADS));
+}
+
+internal void runner_start_pool(size_t worker_count) {
+
+    bool pool_ok = thread_pool_init(&runner_pool, worker_count);
+    assert(pool_ok && "Could not start the worker threads");
+
+    runner_pin_policy = topology_pin_pool(&runner_pool, pin_policy_from_env(PIN_POLICY));
+}
+
+internal void runner_set_thread_count(runner_part_t *part, size_t thread_count) {
+
+    if (thread_count == 0) thread_count = 1;
+    if (thread_count > RUNNER_MAX_THREADS) thread_count = RUNNER_MAX_THREADS;
+
+    if (part->common.thread_count != 0) {
+        pthread_barrier_destroy(&part->common.barrier);
+    }
+
+    part->common.thread_count = thread_count;
+    pthread_barrier_init(&part->common.barrier, NULL, thread_count);
+    spin_barrier_init(&part->common.spin_barrier, thread_count);
+
+    for (size_t i = 0; i < thread_count; ++i) {
+        part->contexts[i].thread_idx = i;
+        part->contexts[i].common     = &part->common;
+    }
+}
+
+/* Runs the solve function of a thread, timing its phases */
+internal void *runner_solve_timed(void *arg) {
+
+    struct part_context *ctx = arg;
+
+    memset(ctx->phases.elapsed, 0, sizeof (ctx->phases.elapsed));
+    ctx->phases.current = PHASE_SETUP;
+    ctx->phases.mark    = now_ns();
+
+    void *result = ctx->common->solve(ctx);
+
+    ctx->phases.elapsed[ctx->phases.current] += now_ns() - ctx->phases.mark;
+
+    return result;
+}
+
+/* Runs the solve function of a thread, reading its counters before and after */
+internal void *runner_solve_counted(void *arg) {
+
+    struct part_context *ctx = arg;
+
+    /* The threads of the pool live as long as the program, so their counters are only opened once */
+    if (!runner_perf_opened) {
+        perf_group_open(&runner_perf_group);
+        runner_perf_opened = true;
+    }
+
+    perf_sample_t start;
+    perf_sample_t end;
+
+    perf_group_read(&runner_perf_group, &start);
+    void *result = ctx->common->solve(ctx);
+    perf_group_read(&runner_perf_group, &end);
+
+    perf_sample_delta(&end, &start, &ctx->counters);
+
+    return result;
+}
+
+internal void runner_run_part(runner_part_t *part) {
+
+    memset(part->data, 0, part->data_size);
+    atomic_store_explicit(&part->common.input_cursor, 0, memory_order_relaxed);
+
+    part->common.solve = part->solve;
+    part_solve_fn solve = part->solve;
+    if (part->common.time_phases)  solve = runner_solve_timed;
+    if (part->common.count_events) solve = runner_solve_counted;
+
+    if (part->common.thread_count > 1) {
+        thread_pool_run(&runner_pool, solve, part->contexts, sizeof (part->contexts[0]), part->common.thread_count);
+    } else {
+        /* When running single-threaded, call the function directly to avoid overhead */
+        solve(&part->contexts[0]);
+    }
+}
+
+internal void runner_benchmark_part(runner_day_t *day, size_t part_idx) {
+
+    if (day->benchmark_runs == 0) return;
+
+    runner_part_t *part = &day->parts[part_idx];
+
+    bench_config_t config = BENCH_DEFAULT_CONFIG;
+    config.min_runs = day->benchmark_runs;
+    config.max_runs = (max(config.max_runs, config.min_runs));
+
+    bench_t bench;
+    bench_init(&bench, &config);
+
+    /* Time of each phase in each measured run, phase_times[phase * max_runs + run] */
+    u64 *phase_times = malloc(PHASE_COUNT * config.max_runs * sizeof (u64));
+    assert(phase_times && "Could not allocate the phase times");
+
+    part->common.time_phases = true;
+
+    while (bench_next(&bench)) {
+        u64 clock_start = timer_ticks();
+        runner_run_part(part);
+        u64 clock_end = timer_ticks_end();
+        arena_reset(runner_solution_arena.alloc_ctx);
+
+        if (!bench_record(&bench, timer_ticks_to_ns(clock_end - clock_start))) continue;
+
+        /* The part is only as fast as its slowest thread in each phase */
+        size_t run = bench.count - 1;
+        for (size_t phase = 0; phase < PHASE_COUNT; ++phase) {
+            u64 slowest = 0;
+            for (size_t t = 0; t < part->common.thread_count; ++t) {
+                slowest = (max(slowest, part->contexts[t].phases.elapsed[phase]));
+            }
+            phase_times[phase * config.max_runs + run] = slowest;
+        }
+    }
+
+    part->common.time_phases = false;
+
+    bench_stats_t stats = bench_stats(&bench);
+    size_t runs = stats.runs;
+
+    printf("Part %zu stats (ns, %zu runs after %zu warmup, %zu outliers):\n",
+            part_idx + 1, runs, stats.warmup_runs, stats.outliers);
+    printf("  %12s %12s %12s %12s %12s\n", "min", "median", "p90", "p99", "max");
+    printf("  %'12lu %'12lu %'12lu %'12lu %'12lu\n", stats.min, stats.median, stats.p90, stats.p99, stats.max);
+    printf("  mean %'.0f ± %.2f%% (95%% CI%s), CV %.2f%%, MAD %'lu\n",
+            stats.mean, stats.precision * 100.0, stats.converged ? "" : ", target not reached",
+            stats.cv * 100.0, stats.mad);
+
+    printf("Part %zu phases (ns):\n", part_idx + 1);
+    printf("  %-9s %12s %12s %12s\n", "phase", "min", "median", "max");
+
+    for (size_t phase = 0; phase < PHASE_COUNT; ++phase) {
+        u64 *times = &phase_times[phase * config.max_runs];
+        qsort(times, runs, sizeof (u64), bench_compare_u64);
+
+        printf("  %-9s %'12lu %'12lu %'12lu\n", part_phase_names[phase], times[0], times[runs / 2], times[runs - 1]);
+    }
+
+    free(phase_times);
+
+    runner_record_results(day, part_idx, &bench, &stats);
+    bench_free(&bench);
+}
+
+typedef struct {
+    cache_evictor_t *evictor;
+    size_t           thread_idx;
+} runner_evict_arg_t;
+
+internal void *runner_evict_task(void *arg) {
+    runner_evict_arg_t *evict = arg;
+    cache_evict_slice(evict->evictor, evict->thread_idx);
+    return NULL;
+}
+
+/* Evicts the caches of every thread that runs the part (the same workers run the same task index) */
+internal void runner_evict_caches(cache_evictor_t *evictor, size_t thread_count) {
+
+    runner_evict_arg_t args[RUNNER_MAX_THREADS];
+    for (size_t i = 0; i < thread_count; ++i) {
+        args[i] = (runner_evict_arg_t) { .evictor = evictor, .thread_idx = i };
+    }
+
+    if (thread_count > 1) {
+        thread_pool_run(&runner_pool, runner_evict_task, args, sizeof (args[0]), thread_count);
+    } else {
+        runner_evict_task(&args[0]);
+    }
+}
+
+internal void runner_cold_benchmark(runner_day_t *day, size_t part_idx) {
+
+    static const char *mode_names[CACHE_MODE_COUNT] = {
+        [CACHE_WARM]        = "warm",
+        [CACHE_COLD]        = "cold",
+        [CACHE_COLD_RELOAD] = "cold, read input",
+    };
+
+    if (day->benchmark_runs == 0) return;
+
+    runner_part_t *part = &day->parts[part_idx];
+    size_t thread_count = part->common.thread_count;
+
+    cache_evictor_t evictor;
+    if (!cache_evictor_init(&evictor, thread_count)) {
+        fprintf(stderr, "Could not allocate the buffer to evict the caches\n");
+        return;
+    }
+
+    char path[64];
+    runner_input_path(day->number, path, sizeof (path));
+
+    bench_config_t config = BENCH_DEFAULT_CONFIG;
+    config.min_runs = day->benchmark_runs;
+    config.max_runs = (max(RUNNER_COLD_MAX_RUNS, config.min_runs));
+
+    printf("Part %zu warm vs cold caches (ns, evicting %zu MB per run):\n", part_idx + 1, evictor.size >> 20);
+    printf("  %-16s %6s %12s %12s %12s %12s\n", "mode", "runs", "min", "median", "p90", "p99");
+
+    for (size_t mode = 0; mode < CACHE_MODE_COUNT; ++mode) {
+        bench_t bench;
+        bench_init(&bench, &config);
+
+        while (bench_next(&bench)) {
+            if (mode != CACHE_WARM) runner_evict_caches(&evictor, thread_count);
+
+            u64 clock_start = timer_ticks();
+            if (mode == CACHE_COLD_RELOAD) {
+                /* Same buffer as before, the input is the only thing in the file arena */
+                arena_reset(runner_file_arena.alloc_ctx);
+                if (!runner_read_input(day, path)) {
+                    fprintf(stderr, "Could not read %s again\n", path);
+                    break;
+                }
+            }
+            runner_run_part(part);
+            u64 clock_end = timer_ticks_end();
+            arena_reset(runner_solution_arena.alloc_ctx);
+
+            bench_record(&bench, timer_ticks_to_ns(clock_end - clock_start));
+        }
+
+        bench_stats_t stats = bench_stats(&bench);
+        printf("  %-16s %6zu %'12lu %'12lu %'12lu %'12lu\n",
+                mode_names[mode], stats.runs, stats.min, stats.median, stats.p90, stats.p99);
+
+        bench_free(&bench);
+    }
+
+    cache_evictor_free(&evictor);
+}
+
+/* Writes s as a JSON (or CSV) string, the flags are the only field that needs it */
+internal void runner_write_quoted(FILE *file, const char *s, char escape) {
+    fputc('"', file);
+    for (; *s; ++s) {
+        if (*s == '"' || *s == escape) fputc(escape, file);
+        fputc(*s, file);
+    }
+    fputc('"', file);
+}
+
+internal void runner_record_results(runner_day_t *day, size_t part_idx, const bench_t *bench, const bench_stats_t *stats) {
+
+    const char *path = getenv("AOC_RESULTS");
+    if (!path || !*path) return;
+
+    size_t path_length = strlen(path);
+    bool   csv         = path_length >= 4 && strcmp(path + path_length - 4, ".csv") == 0;
+
+    FILE *file = fopen(path, "a");
+    if (!file) {
+        fprintf(stderr, "Could not write the results to %s\n", path);
+        return;
+    }
+
+    /* The numbers are printed with the pt_BR locale, which would put commas in the decimals */
+    locale_t c_locale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+    locale_t previous = uselocale(c_locale);
+
+    runner_part_t *part = &day->parts[part_idx];
+    u64 timestamp = (u64)time(NULL);
+
+    if (csv) {
+        fseek(file, 0, SEEK_END);
+        if (ftell(file) == 0) {
+            fprintf(file, "day,part,threads,compiler,flags,timestamp,input_bytes,runs,warmup,outliers,"
+                          "min,median,p90,p99,max,mad,mean,stddev,cv\n");
+        }
+        fprintf(file, "%u,%zu,%zu,", day->number, part_idx + 1, part->common.thread_count);
+        runner_write_quoted(file, __VERSION__, '"');
+        fputc(',', file);
+        runner_write_quoted(file, RUNNER_BUILD_FLAGS, '"');
+        fprintf(file, ",%lu,%zu,%zu,%zu,%zu,%lu,%lu,%lu,%lu,%lu,%lu,%.1f,%.1f,%.6f\n",
+                timestamp, day->input.count, stats->runs, stats->warmup_runs, stats->outliers,
+                stats->min, stats->median, stats->p90, stats->p99, stats->max, stats->mad,
+                stats->mean, stats->stddev, stats->cv);
+    } else {
+        fprintf(file, "{\"day\":%u,\"part\":%zu,\"threads\":%zu,\"compiler\":",
+                day->number, part_idx + 1, part->common.thread_count);
+        runner_write_quoted(file, __VERSION__, '\\');
+        fprintf(file, ",\"flags\":");
+        runner_write_quoted(file, RUNNER_BUILD_FLAGS, '\\');
+        fprintf(file, ",\"timestamp\":%lu,\"input_bytes\":%zu,\"runs\":%zu,\"warmup\":%zu,\"outliers\":%zu,"
+                      "\"min\":%lu,\"median\":%lu,\"p90\":%lu,\"p99\":%lu,\"max\":%lu,\"mad\":%lu,"
+                      "\"mean\":%.1f,\"stddev\":%.1f,\"cv\":%.6f,\"samples\":[",
+                timestamp, day->input.count, stats->runs, stats->warmup_runs, stats->outliers,
+                stats->min, stats->median, stats->p90, stats->p99, stats->max, stats->mad,
+                stats->mean, stats->stddev, stats->cv);
+        for (size_t i = 0; i < bench->count; ++i) {
+            fprintf(file, i > 0 ? ",%lu" : "%lu", bench->samples[i]);
+        }
+        fprintf(file, "]}\n");
+    }
+
+    uselocale(previous);
+    freelocale(c_locale);
+    fclose(file);
+}
+
+internal void runner_count_part(runner_day_t *day, size_t part_idx) {
+
+    size_t runs = day->benchmark_runs;
+    if (runs == 0) return;
+
+    runner_part_t *part = &day->parts[part_idx];
+    size_t thread_count = part->common.thread_count;
+
+    /* Totals over every thread and run, and the task clock of each thread over the runs */
+    u64 totals[PERF_COUNTER_COUNT] = {0};
+    u64 task_clocks[RUNNER_MAX_THREADS] = {0};
+    u32 available = ~0u;
+
+    part->common.count_events = true;
+
+    /* The first run opens the counters of each thread */
+    for (size_t i = 0; i <= runs; ++i) {
+        runner_run_part(part);
+        arena_reset(runner_solution_arena.alloc_ctx);
+        if (i == 0) continue;
+
+        for (size_t t = 0; t < thread_count; ++t) {
+            perf_sample_t *counters = &part->contexts[t].counters;
+            available &= counters->available;
+
+            for (size_t c = 0; c < PERF_COUNTER_COUNT; ++c) totals[c] += counters->values[c];
+            task_clocks[t] += counters->values[PERF_TASK_CLOCK];
+        }
+    }
+
+    part->common.count_events = false;
+
+    if (available == 0) {
+        /* The calling thread always runs the first context */
+        printf("Part %zu counters: not available (perf_event_open: %s, see /proc/sys/kernel/perf_event_paranoid)\n",
+                part_idx + 1, strerror(runner_perf_group.error));
+        return;
+    }
+
+    printf("Part %zu counters (user space, per run, all threads):\n", part_idx + 1);
+
+    for (size_t c = 0; c < PERF_COUNTER_COUNT; ++c) {
+        if (c == PERF_TASK_CLOCK) continue;
+
+        if (!(available & (1u << c))) {
+            printf("  %-14s %16s\n", perf_counter_name(c), "n/a");
+            continue;
+        }
+
+        u64 per_run = totals[c] / runs;
+        printf("  %-14s %'16lu", perf_counter_name(c), per_run);
+
+        if (c == PERF_INSTRUCTIONS && (available & (1u << PERF_CYCLES)) && totals[PERF_CYCLES] > 0) {
+            printf("  (IPC %.2f)", (double)totals[PERF_INSTRUCTIONS] / (double)totals[PERF_CYCLES]);
+        }
+        if ((c == PERF_CACHE_MISSES || c == PERF_BRANCH_MISSES) && day->input.count > 0) {
+            printf("  (%.4f per input byte)", (double)per_run / (double)day->input.count);
+        }
+        printf("\n");
+    }
+
+    if (available & (1u << PERF_TASK_CLOCK)) {
+        printf("  %-14s per thread (ns):", perf_counter_name(PERF_TASK_CLOCK));
+        for (size_t t = 0; t < thread_count; ++t) printf(" %'lu", task_clocks[t] / runs);
+        printf("\n");
+    }
+}
+
+internal u64 runner_autotune_run(void *arg, size_t thread_count, string_t *output) {
+
+    runner_part_t *part = arg;
+
+    arena_reset(runner_solution_arena.alloc_ctx);
+    runner_set_thread_count(part, thread_count);
+
+    u64 clock_start = timer_ticks();
+    runner_run_part(part);
+    u64 clock_end = timer_ticks_end();
+
+    *output = part->common.output;
+    return timer_ticks_to_ns(clock_end - clock_start);
+}
+
+internal void runner_autotune(runner_day_t *day) {
+
+    size_t thread_counts[RUNNER_PART_COUNT];
+
+    for (size_t i = 0; i < RUNNER_PART_COUNT; ++i) {
+        runner_part_t *part = &day->parts[i];
+        thread_counts[i] = part->common.thread_count;
+
+        if (!part->solve) continue;
+
+        char label[16];
+        snprintf(label, sizeof (label), "Part %zu", i + 1);
+        thread_counts[i] = autotune_part(label, runner_autotune_run, part, RUNNER_MAX_THREADS);
+    }
+
+    tuning_t tuning = {
+        .p1_threads = thread_counts[0],
+        .p2_threads = thread_counts[1],
+        .input_size = day->input.count,
+    };
+
+    if (tuning_save(day->number, &tuning)) {
+        printf("Tuning saved to "TUNING_FOLDER"day_%02u.txt\n", day->number);
+    } else {
+        fprintf(stderr, "Could not save the tuning to "TUNING_FOLDER"day_%02u.txt\n", day->number);
+    }
+}
+
+internal void runner_scaling(runner_day_t *day, const char *csv_path) {
+
+    size_t max_threads = runner_online_threads();
+
+    FILE *csv = NULL;
+    if (csv_path) {
+        csv = fopen(csv_path, "a");
+        if (!csv) fprintf(stderr, "Could not write the scaling to %s\n", csv_path);
+    }
+
+    /* The CSV is written in the C locale, the pt_BR one would put commas in the decimals */
+    locale_t c_locale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+
+    if (csv) {
+        fseek(csv, 0, SEEK_END);
+        if (ftell(csv) == 0) fprintf(csv, "day,part,threads,median_ns,p90_ns,speedup,efficiency,correct\n");
+    }
+
+    bench_config_t config = BENCH_DEFAULT_CONFIG;
+    config.min_runs    = (max(day->benchmark_runs, 1));
+    config.max_time_ns = 200 * 1000 * 1000;
+
+    for (size_t i = 0; i < RUNNER_PART_COUNT; ++i) {
+        runner_part_t *part = &day->parts[i];
+        if (!part->solve) continue;
+
+        size_t default_threads = part->common.thread_count;
+
+        char   reference[AUTOTUNE_MAX_OUTPUT];
+        size_t reference_count = 0;
+        u64    single_median   = 0;
+
+        printf("Part %zu thread scaling:\n", i + 1);
+        printf("  %8s %16s %16s %9s %11s\n", "threads", "median (ns)", "p90 (ns)", "speedup", "efficiency");
+
+        for (size_t threads = 1; threads <= max_threads; ++threads) {
+            runner_set_thread_count(part, threads);
+
+            bench_t bench;
+            bench_init(&bench, &config);
+
+            bool correct = true;
+            while (bench_next(&bench)) {
+                u64 clock_start = timer_ticks();
+                runner_run_part(part);
+                u64 clock_end = timer_ticks_end();
+
+                string_t output = part->common.output;
+                if (threads == 1 && bench.count == 0 && bench.warmup_done == 0) {
+                    reference_count = (min(output.count, AUTOTUNE_MAX_OUTPUT));
+                    memcpy(reference, output.chars, reference_count);
+                } else {
+                    correct &= output.count == reference_count && memcmp(output.chars, reference, reference_count) == 0;
+                }
+                arena_reset(runner_solution_arena.alloc_ctx);
+
+                bench_record(&bench, timer_ticks_to_ns(clock_end - clock_start));
+            }
+
+            bench_stats_t stats = bench_stats(&bench);
+            bench_free(&bench);
+
+            if (threads == 1) single_median = stats.median;
+
+            double speedup    = (double)single_median / (double)(max(stats.median, 1));
+            double efficiency = speedup / (double)threads;
+
+            printf("  %8zu %'16lu %'16lu %8.2fx %10.1f%%%s\n", threads, stats.median, stats.p90,
+                    speedup, efficiency * 100.0, correct ? "" : "  (wrong answer)");
+
+            if (csv) {
+                locale_t previous = uselocale(c_locale);
+                fprintf(csv, "%u,%zu,%zu,%lu,%lu,%.4f,%.4f,%d\n", day->number, i + 1, threads,
+                        stats.median, stats.p90, speedup, efficiency, correct);
+                uselocale(previous);
+            }
+        }
+
+        runner_set_thread_count(part, default_threads);
+    }
+
+    freelocale(c_locale);
+    if (csv) {
+        fclose(csv);
+        printf("Scaling appended to %s\n", csv_path);
+    }
+}
+
+/* Adds the regular files of a directory, or the path itself if it is not a directory */
+internal void runner_batch_collect(const char *path, char ***paths, size_t *count, size_t *capacity) {
+
+    struct stat path_stat;
+    if (stat(path, &path_stat) != 0) {
+        fprintf(stderr, "Skipping %s: not found\n", path);
+        return;
+    }
+
+    if (!S_ISDIR(path_stat.st_mode)) {
+        if (*count == *capacity) {
+            *capacity = *capacity ? *capacity * 2 : 64;
+            *paths    = realloc(*paths, *capacity * sizeof (char *));
+            assert(*paths && "Could not allocate the batch paths");
+        }
+        (*paths)[(*count)++] = strdup(path);
+        return;
+    }
+
+    DIR *dir = opendir(path);
+    if (!dir) return;
+
+    struct dirent *entry;
+    while ((entry = readdir(dir))) {
+        if (entry->d_name[0] == '.') continue;
+
+        char entry_path[4096];
+        snprintf(entry_path, sizeof (entry_path), "%s/%s", path, entry->d_name);
+
+        struct stat entry_stat;
+        if (stat(entry_path, &entry_stat) == 0 && S_ISREG(entry_stat.st_mode)) {
+            runner_batch_collect(entry_path, paths, count, capacity);
+        }
+    }
+
+    closedir(dir);
+}
+
+internal int runner_compare_cstr(const void *a, const void *b) {
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+internal int runner_batch(runner_day_t *day, int path_count, char **paths) {
+
+    char   **inputs         = NULL;
+    size_t   input_count    = 0;
+    size_t   input_capacity = 0;
+
+    for (int i = 0; i < path_count; ++i) {
+        runner_batch_collect(paths[i], &inputs, &input_count, &input_capacity);
+    }
+
+    if (input_count == 0) {
+        fprintf(stderr, "Usage: --batch <directory or file>...\n");
+        return 1;
+    }
+
+    qsort(inputs, input_count, sizeof (inputs[0]), runner_compare_cstr);
+
+    /* Time to read and solve each input */
+    u64 *latencies = malloc(input_count * sizeof (u64));
+    assert(latencies && "Could not allocate the batch latencies");
+
+    /* The parts are set up (and the threads started) once, with the size of the first input for the tuning check */
+    if (!runner_read_input(day, inputs[0])) day->input = (string_t) {0};
+    runner_setup_parts(day);
+
+    size_t max_threads = 1;
+    for (size_t i = 0; i < RUNNER_PART_COUNT; ++i) {
+        max_threads = (max(max_threads, day->parts[i].common.thread_count));
+    }
+    runner_start_pool(max_threads - 1);
+
+    printf("\n==== Day %02u (batch of %zu inputs) ====\n", day->number, input_count);
+
+    size_t solved      = 0;
+    size_t total_bytes = 0;
+
+    u64 batch_start = now_ns();
+
+    for (size_t i = 0; i < input_count; ++i) {
+
+        u64 clock_start = now_ns();
+
+        /* The days size their data from the input, the only limit is the input buffer */
+        struct stat input_stat;
+        if (stat(inputs[i], &input_stat) == 0 && (size_t)input_stat.st_size >= RUNNER_FILE_CAP) {
+            fprintf(stderr, "Skipping %s: %zu bytes, larger than RUNNER_FILE_CAP (build the day with -DRUNNER_FILE_CAP=%zu)\n",
+                    inputs[i], (size_t)input_stat.st_size, (size_t)input_stat.st_size + 1);
+            continue;
+        }
+
+        arena_reset(runner_file_arena.alloc_ctx);
+        if (!runner_read_input(day, inputs[i])) {
+            fprintf(stderr, "Skipping %s: could not be read\n", inputs[i]);
+            continue;
+        }
+
+        const char *rejected = runner_check_input(day);
+        if (rejected) {
+            fprintf(stderr, "Skipping %s: %s\n", inputs[i], rejected);
+            continue;
+        }
+
+        for (size_t j = 0; j < RUNNER_PART_COUNT; ++j) {
+            if (day->parts[j].solve) runner_run_part(&day->parts[j]);
+        }
+
+        u64 clock_end = now_ns();
+
+        printf("%s:", inputs[i]);
+        for (size_t j = 0; j < RUNNER_PART_COUNT; ++j) {
+            if (!day->parts[j].solve) continue;
+            printf(" ");
+            string_print(&day->parts[j].common.output);
+        }
+        printf("\n");
+
+        arena_reset(runner_solution_arena.alloc_ctx);
+
+        latencies[solved++] = clock_end - clock_start;
+        total_bytes += day->input.count;
+    }
+
+    u64 batch_time = now_ns() - batch_start;
+
+    if (solved > 0) {
+        qsort(latencies, solved, sizeof (u64), bench_compare_u64);
+
+        /* Printing the answers is not part of the throughput */
+        u64 busy_time = 0;
+        for (size_t i = 0; i < solved; ++i) busy_time += latencies[i];
+
+        printf("Solved %zu inputs (%zu bytes) in %'lu ns\n", solved, total_bytes, batch_time);
+        printf("Throughput: %.1f inputs/s, %.1f MB/s\n",
+                solved * 1e9 / busy_time, total_bytes * 1e3 / busy_time);
+        printf("Latency per input in ns (read + solve), p50/p90/p99/max: %'lu, %'lu, %'lu, %'lu\n",
+                bench_percentile(latencies, solved, 50), bench_percentile(latencies, solved, 90),
+                bench_percentile(latencies, solved, 99), latencies[solved - 1]);
+    }
+
+    for (size_t i = 0; i < input_count; ++i) free(inputs[i]);
+    free(inputs);
+    free(latencies);
+
+    return solved == input_count ? 0 : 1;
+}
+
+internal void runner_socket_path(u32 day_number, char *path, size_t path_size) {
+
+    const char *env_path = getenv("AOC_SOCKET");
+
+    if (env_path) {
+        snprintf(path, path_size, "%s", env_path);
+    } else {
+        snprintf(path, path_size, "/tmp/aoc_day_%02u.sock", day_number);
+    }
+}
+
+/* Reads an input of input_size bytes from the client, solves it and writes the response. Returns its length. */
+internal size_t runner_daemon_solve(runner_day_t *day, int client, u64 input_size, char *response, size_t response_size) {
+
+    arena_reset(runner_file_arena.alloc_ctx);
+
+    char *buffer = input_size < RUNNER_FILE_CAP ? allocator_alloc(&runner_file_arena, input_size + 1) : NULL;
+
+    if (!buffer) {
+        /* Drain the input, so the connection can still be used */
+        char discard[4096];
+        for (u64 left = input_size; left > 0;) {
+            size_t bytes = left < sizeof (discard) ? left : sizeof (discard);
+            if (!unix_socket_recv_all(client, discard, bytes)) break;
+            left -= bytes;
+        }
+        return snprintf(response, response_size, "Error: the input is larger than %zu bytes\n", (size_t)RUNNER_FILE_CAP - 1);
+    }
+
+    if (!unix_socket_recv_all(client, buffer, input_size)) return 0;
+
+    buffer[input_size] = '\0';
+    day->input = (string_t) { .chars = buffer, .count = input_size };
+    day->shape = input_shape_detect(day->input);
+
+    const char *rejected = runner_check_input(day);
+    if (rejected) return snprintf(response, response_size, "Error: %s\n", rejected);
+
+    size_t length     = 0;
+    u64    total_time = 0;
+
+    for (size_t i = 0; i < RUNNER_PART_COUNT; ++i) {
+        runner_part_t *part = &day->parts[i];
+        if (!part->solve) continue;
+
+        u64 clock_start = now_ns();
+        runner_run_part(part);
+        u64 clock_end = now_ns();
+
+        total_time += clock_end - clock_start;
+
+        string_t output = part->common.output;
+        length += snprintf(response + length, response_size - length, "Part %zu: %.*s (%'lu ns)\n",
+                i + 1, (int)output.count, output.chars, clock_end - clock_start);
+        if (length >= response_size) length = response_size - 1;
+
+        arena_reset(runner_solution_arena.alloc_ctx);
+    }
+
+    length += snprintf(response + length, response_size - length, "Total: %'lu ns\n", total_time);
+    if (length >= response_size) length = response_size - 1;
+
+    return length;
+}
+
+internal int runner_daemon(runner_day_t *day) {
+
+    char path[108];
+    runner_socket_path(day->number, path, sizeof (path));
+
+    /* Set up with the usual input of the day if there is one, it is only used for the tuning check */
+    char input_path[64];
+    runner_input_path(day->number, input_path, sizeof (input_path));
+    if (!runner_read_input(day, input_path)) day->input = (string_t) {0};
+    runner_setup_parts(day);
+
+    size_t max_threads = 1;
+    for (size_t i = 0; i < RUNNER_PART_COUNT; ++i) {
+        max_threads = (max(max_threads, day->parts[i].common.thread_count));
+    }
+    runner_start_pool(max_threads - 1);
+
+    int listener = unix_socket_listen(path);
+    if (listener < 0) {
+        fprintf(stderr, "Could not listen on %s\n", path);
+        return 1;
+    }
+
+    printf("Day %02u listening on %s\n", day->number, path);
+    fflush(stdout);
+
+    char response[4096];
+    bool running   = true;
+    int  exit_code = 0;
+
+    while (running) {
+        int client = accept(listener, NULL, NULL);
+        if (client < 0) {
+            /* Interrupted, or the client gave up before it was accepted */
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+
+            /* Anything else (out of file descriptors, ...) would fail again right away */
+            fprintf(stderr, "Could not accept a connection on %s: %s\n", path, strerror(errno));
+            exit_code = 1;
+            break;
+        }
+
+        /* Every request of a connection is answered before accepting the next one */
+        u64 input_size;
+        while (unix_socket_recv_size(client, &input_size)) {
+            if (input_size == RUNNER_DAEMON_STOP) {
+                running = false;
+                break;
+            }
+
+            size_t length = runner_daemon_solve(day, client, input_size, response, sizeof (response));
+            if (length == 0 || !unix_socket_send_message(client, response, length)) break;
+        }
+
+        close(client);
+    }
+
+    close(listener);
+    unlink(path);
+
+    return exit_code;
+}
+
+internal int runner_client(runner_day_t *day, int path_count, char **paths) {
+
+    if (path_count == 0) {
+        fprintf(stderr, "Usage: --client <input file | --stop>...\n");
+        return 1;
+    }
+
+    char path[108];
+    runner_socket_path(day->number, path, sizeof (path));
+
+    int fd = unix_socket_connect(path);
+    if (fd < 0) {
+        fprintf(stderr, "Could not connect to %s, start the daemon with --daemon\n", path);
+        return 1;
+    }
+
+    int exit_code = 0;
+
+    for (int i = 0; i < path_count; ++i) {
+
+        if (strcmp(paths[i], "--stop") == 0) {
+            u64 stop = RUNNER_DAEMON_STOP;
+            unix_socket_send_all(fd, &stop, sizeof (stop));
+            break;
+        }
+
+        arena_reset(runner_file_arena.alloc_ctx);
+        if (!runner_read_input(day, paths[i])) {
+            fprintf(stderr, "Skipping %s: could not be read\n", paths[i]);
+            exit_code = 1;
+            continue;
+        }
+
+        u64 clock_start = now_ns();
+
+        u64   response_size;
+        char *response = NULL;
+        bool  ok = unix_socket_send_message(fd, day->input.chars, day->input.count)
+                && unix_socket_recv_size(fd, &response_size)
+                && (response = malloc(response_size + 1))
+                && unix_socket_recv_all(fd, response, response_size);
+
+        u64 clock_end = now_ns();
+
+        if (!ok) {
+            fprintf(stderr, "The daemon closed the connection\n");
+            free(response);
+            exit_code = 1;
+            break;
+        }
+
+        response[response_size] = '\0';
+        printf("%s:\n%sRound trip: %'lu ns\n", paths[i], response, clock_end - clock_start);
+
+        free(response);
+    }
+
+    close(fd);
+
+    return exit_code;
+}
+
+#endif /* ifdef RUNNER_IMPL */
+
+#endif /* ifndef RUNNER_H */
@@ -1,3 +1,6 @@
+#ifndef SPLITS_H
+#define SPLITS_H
+
 #include <stddef.h>
 #include <stdbool.h>
 #include "typedefs.h"
@@ -15,3 +18,43 @@ internal void split_count_evenly(size_t idx, size_t part_count, size_t count, si
     *start =  idx   * tasks_per_thread + prev_remainders;
     *end   = *start + tasks_per_thread + (take_remainder ? 1 : 0);
 }
+
+/*
+ * Lower bound: first index i in [0, count] such that prefix[i] >= target.
+ *
+ * prefix - Prefix sums of the weights (count + 1 entries, prefix[0] = 0).
+ */
+internal inline size_t split_find_weight(const u64 *prefix, size_t count, u64 target) {
+
+    size_t low  = 0;
+    size_t high = count;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (prefix[mid] < target) low = mid + 1;
+        else                      high = mid;
+    }
+
+    return low;
+}
+
+/*
+ * Like split_count_evenly, but the parts get (roughly) the same total weight instead of
+ * the same number of items. The parts are contiguous and cover [0, count) without gaps.
+ *
+ * prefix - Prefix sums of the weights of the items: prefix[i] is the total weight of
+ *          items [0, i), so it has count + 1 entries and prefix[0] = 0.
+ */
+internal void split_weights_evenly(size_t idx, size_t part_count, const u64 *prefix, size_t count, size_t *start, size_t *end) {
+
+    const u64 total = prefix[count];
+
+    /* 128-bit products, so huge weights don't overflow */
+    const u64 start_weight = (u64)((unsigned __int128)total *  idx      / part_count);
+    const u64 end_weight   = (u64)((unsigned __int128)total * (idx + 1) / part_count);
+
+    *start = idx == 0              ? 0     : split_find_weight(prefix, count, start_weight);
+    *end   = idx == part_count - 1 ? count : split_find_weight(prefix, count, end_weight);
+}
+
+#endif /* ifndef SPLITS_H */
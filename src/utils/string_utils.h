@@ -29,43 +29,43 @@ typedef struct {
 
 
 /* Creates a new string builder from a C string */
-string_builder_t sb_from_cstr(const char *cstr, const allocator_t *allocator);
+internal string_builder_t sb_from_cstr(const char *cstr, const allocator_t *allocator);
 /* Creates a new string builder with a given capacity */
-string_builder_t sb_with_capacity(const size_t capacity, const allocator_t *allocator);
+internal force_inline string_builder_t sb_with_capacity(const size_t capacity, const allocator_t *allocator);
 /* Creates a new string builder from a file */
-string_builder_t sb_read_file(FILE *file, const allocator_t *allocator);
+internal string_builder_t sb_read_file(FILE *file, const allocator_t *allocator);
 
 /* Append a character */
-void sb_append_char(string_builder_t *sb, const char ch);
+internal void sb_append_char(string_builder_t *sb, const char ch);
 /* Append a null terminated string */
-void *sb_append_cstr(string_builder_t *sb, const char *cstr);
+internal void *sb_append_cstr(string_builder_t *sb, const char *cstr);
 /* Append a sized string */
-void sb_append_str(string_builder_t *sb, const string_t str);
+internal void sb_append_str(string_builder_t *sb, const string_t str);
 /* Append the contents of another string builder */
-void sb_append_sb(string_builder_t *sb, const string_builder_t *other);
+internal void sb_append_sb(string_builder_t *sb, const string_builder_t *other);
 /* Build the string(view) from a string builder */
-string_t sb_build(string_builder_t *sb);
+internal string_t sb_build(string_builder_t *sb);
 
 /* Joins the array of strings to a string builder, separated by a delimiter (optional) */
-string_builder_t string_array_join_by_char(string_array_t array, char delimiter, const allocator_iface *allocator, void *alloc_ctx);
+internal string_builder_t string_array_join_by_char(string_array_t array, char delimiter, const allocator_iface *allocator, void *alloc_ctx);
 
 /* Builds a string directly from a cstr (chars will point to the same memory address as the cstr). */
-string_t string_from_cstr(const char *cstr);
+internal string_t string_from_cstr(const char *cstr);
 /* Compares two strings, character by character */
-bool string_equals(const string_t *str, const string_t *other);
+internal bool string_equals(const string_t *str, const string_t *other);
 
 /* Split a string by a given delimiter */
-string_array_t string_split_by_char(const string_t *str, const char delimiter, const allocator_t *allocator);
-string_array_t string_split_by_str(const string_t *str, const string_t *delimiter, const allocator_t *allocator);
+internal string_array_t string_split_by_char(const string_t *str, const char delimiter, const allocator_t *allocator);
+internal string_array_t string_split_by_str(const string_t *str, const string_t *delimiter, const allocator_t *allocator);
 
-void string_print(const string_t *str);
-void string_println(const string_t *str);
-void string_sprint(char *buffer, const string_t *str);
-void string_sprintln(char *buffer, const string_t *str);
+internal void string_print(const string_t *str);
+internal void string_println(const string_t *str);
+internal void string_sprint(char *buffer, const string_t *str);
+internal void string_sprintln(char *buffer, const string_t *str);
 
 /* Convert integer types to strings */
-string_builder_t sb_from_u64(const uint64_t value, const allocator_t *allocator);
-string_builder_t sb_from_i64(const int64_t value, const allocator_t *allocator);
+internal string_builder_t sb_from_u64(const uint64_t value, const allocator_t *allocator);
+internal string_builder_t sb_from_i64(const int64_t value, const allocator_t *allocator);
 
 
 #define STRING_UTILS_IMPL
@@ -75,7 +75,7 @@ string_builder_t sb_from_i64(const int64_t value, const allocator_t *allocator);
 #include <stdlib.h>
 #include <stdio.h>
 
-string_builder_t sb_from_cstr(const char *cstr, const allocator_t *allocator) {
+internal string_builder_t sb_from_cstr(const char *cstr, const allocator_t *allocator) {
     
 
     size_t count = strlen(cstr);
@@ -98,7 +98,7 @@ string_builder_t sb_from_cstr(const char *cstr, const allocator_t *allocator) {
 
     return sb;
 }
-string_builder_t sb_with_capacity(const size_t capacity, const allocator_t *allocator) {
+internal force_inline string_builder_t sb_with_capacity(const size_t capacity, const allocator_t *allocator) {
     
     string_builder_t sb = {
         .array_info = {
@@ -119,7 +119,7 @@ string_builder_t sb_with_capacity(const size_t capacity, const allocator_t *allo
 }
 
 /* Creates a new string builder from a file */
-string_builder_t sb_read_file(FILE *file, const allocator_t *allocator) {
+internal string_builder_t sb_read_file(FILE *file, const allocator_t *allocator) {
     string_builder_t sb = {
         .array_info = {
             .item_size = sizeof (char),
@@ -145,13 +145,13 @@ string_builder_t sb_read_file(FILE *file, const allocator_t *allocator) {
 }
 
 
-void sb_append_char(string_builder_t *sb, const char ch) {
+internal void sb_append_char(string_builder_t *sb, const char ch) {
     sb->items = da_reserve(sb->items, &sb->array_info, sb->array_info.count + 1);
     sb->items[sb->array_info.count++] = ch;
     sb->items[sb->array_info.count] = '\0'; /* Ensure null termination */
 }
 
-void *sb_append_cstr(string_builder_t *sb, const char *cstr) {
+internal void *sb_append_cstr(string_builder_t *sb, const char *cstr) {
     size_t length = strlen(cstr);
 
     sb->items = da_reserve(sb->items, &sb->array_info, sb->array_info.count + length);
@@ -162,21 +162,21 @@ void *sb_append_cstr(string_builder_t *sb, const char *cstr) {
     return sb->items;
 }
 
-void sb_append_str(string_builder_t *sb, const string_t str) {
+internal void sb_append_str(string_builder_t *sb, const string_t str) {
     sb->items = da_reserve(sb->items, &sb->array_info, sb->array_info.count + str.count);
     memcpy(sb->items + sb->array_info.count, str.chars, str.count);
     sb->array_info.count += str.count;
     sb->items[sb->array_info.count] = '\0'; /* Ensure null termination */
 }
 
-void sb_append_sb(string_builder_t *sb, const string_builder_t *other) {
+internal void sb_append_sb(string_builder_t *sb, const string_builder_t *other) {
     sb->items = da_reserve(sb->items, &sb->array_info, sb->array_info.count + other->array_info.count + 1);
     memcpy(&sb->items[sb->array_info.count], other->items, other->array_info.count);
     sb->array_info.count += other->array_info.count;
     sb->items[sb->array_info.count] = '\0'; /* Ensure null termination */
 }
 
-string_t sb_build(string_builder_t *sb) {
+internal string_t sb_build(string_builder_t *sb) {
     string_t result = {
         .chars = sb->items,
         .count = sb->array_info.count
@@ -186,7 +186,7 @@ string_t sb_build(string_builder_t *sb) {
 
 }
 
-string_t string_from_cstr(const char *cstr) {
+internal string_t string_from_cstr(const char *cstr) {
 
     const char *ch = cstr;
 
@@ -203,7 +203,7 @@ string_t string_from_cstr(const char *cstr) {
 }
 
 /* O(n) amortized */
-bool string_equals(const string_t *str, const string_t *other) {
+internal bool string_equals(const string_t *str, const string_t *other) {
 
     /* Deal with null pointers */
     if (str == NULL || other == NULL) {
@@ -223,7 +223,7 @@ bool string_equals(const string_t *str, const string_t *other) {
     return true;
 }
 
-string_array_t string_split_by_char(const string_t *str, const char delimiter, const allocator_t *allocator) {
+internal string_array_t string_split_by_char(const string_t *str, const char delimiter, const allocator_t *allocator) {
     string_array_t result = {
         .array_info = {
             .item_size = sizeof (string_t),
@@ -259,7 +259,7 @@ string_array_t string_split_by_char(const string_t *str, const char delimiter, c
     return result;
 }
 
-string_array_t string_split_by_str(const string_t *str, const string_t *delimiter, const allocator_t *allocator) {
+internal string_array_t string_split_by_str(const string_t *str, const string_t *delimiter, const allocator_t *allocator) {
     string_array_t result = {
         .array_info = {
             .allocator = allocator,
@@ -306,21 +306,21 @@ string_array_t string_split_by_str(const string_t *str, const string_t *delimite
 }
 
 
-void string_print(const string_t *str) {
+internal void string_print(const string_t *str) {
     printf("%.*s", (int)str->count, str->chars);
 }
-void string_println(const string_t *str) {
+internal void string_println(const string_t *str) {
     printf("%.*s\n", (int)str->count, str->chars);
 }
 
-void string_sprint(char *buffer, const string_t *str) {
+internal void string_sprint(char *buffer, const string_t *str) {
     sprintf(buffer, "%.*s", (int)str->count, str->chars);
 }
-void string_sprintln(char *buffer, const string_t *str) {
+internal void string_sprintln(char *buffer, const string_t *str) {
     sprintf(buffer, "%.*s\n", (int)str->count, str->chars);
 }
 
-string_builder_t sb_from_u64(const uint64_t value, const allocator_t *allocator) {
+internal string_builder_t sb_from_u64(const uint64_t value, const allocator_t *allocator) {
 
     string_builder_t result = sb_with_capacity(20, allocator);
 
@@ -343,7 +343,7 @@ string_builder_t sb_from_u64(const uint64_t value, const allocator_t *allocator)
     return result;
 }
 
-string_builder_t sb_from_i64(const int64_t value, const allocator_t *allocator) {
+internal string_builder_t sb_from_i64(const int64_t value, const allocator_t *allocator) {
 
     string_builder_t result = sb_with_capacity(20, allocator);
 
@@ -0,0 +1,154 @@
+#include "../barrier.h"
+#include "../thread_pool.h"
+#include "../macros.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TEST_THREADS 4
+#define TEST_PHASES  1000
+
+/* Most threads used for the barrier cost table */
+#define BENCH_MAX_THREADS 16
+#define BENCH_WAITS       20000
+
+typedef struct {
+    enum barrier_type type;
+    size_t            thread_idx;
+    size_t            thread_count;
+    u64               errors;
+    bool              sleep_first;
+} test_worker_t;
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static spin_barrier_t    spin_barrier;
+static pthread_barrier_t pthread_barrier;
+
+static volatile u64 phase_of[BENCH_MAX_THREADS];
+
+static inline u64 now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline void wait_barrier(enum barrier_type type) {
+    if (type == BARRIER_SPIN) {
+        spin_barrier_wait(&spin_barrier);
+    } else {
+        pthread_barrier_wait(&pthread_barrier);
+    }
+}
+
+/* Every thread publishes its phase, then checks that nobody is behind or ahead of it */
+static void *run_phases(void *arg) {
+    test_worker_t *worker = arg;
+
+    for (u64 phase = 1; phase <= TEST_PHASES; ++phase) {
+        if (worker->sleep_first && phase == 1) usleep(20000);
+
+        phase_of[worker->thread_idx] = phase;
+        spin_barrier_wait(&spin_barrier);
+
+        for (size_t i = 0; i < worker->thread_count; ++i) {
+            if (phase_of[i] != phase) worker->errors++;
+        }
+        spin_barrier_wait(&spin_barrier);
+    }
+
+    return NULL;
+}
+
+static void *wait_many(void *arg) {
+    test_worker_t *worker = arg;
+
+    for (size_t i = 0; i < BENCH_WAITS; ++i) wait_barrier(worker->type);
+
+    return NULL;
+}
+
+static void test_phases(thread_pool_t *pool, bool sleep_first, const char *msg) {
+    test_worker_t workers[TEST_THREADS] = {0};
+    for (size_t i = 0; i < TEST_THREADS; ++i) {
+        workers[i].thread_idx   = i;
+        workers[i].thread_count = TEST_THREADS;
+    }
+    /* A late thread makes the others fall back to the futex */
+    workers[TEST_THREADS - 1].sleep_first = sleep_first;
+
+    spin_barrier_init(&spin_barrier, TEST_THREADS);
+    thread_pool_run(pool, run_phases, workers, sizeof (workers[0]), TEST_THREADS);
+
+    u64 errors = 0;
+    for (size_t i = 0; i < TEST_THREADS; ++i) errors += workers[i].errors;
+
+    TEST_ASSERT(errors == 0, msg);
+    TEST_ASSERT(atomic_load(&spin_barrier.arrived) == 0, "no thread left in the barrier");
+}
+
+static void test_type_names(void) {
+    bool names_ok = true;
+    for (enum barrier_type type = 0; type < BARRIER_TYPE_COUNT; ++type) {
+        names_ok &= barrier_type_from_cstr(barrier_type_names[type]) == type;
+    }
+    TEST_ASSERT(names_ok, "barrier names round trip");
+    TEST_ASSERT(barrier_type_from_cstr("bogus") == BARRIER_TYPE_COUNT, "unknown barrier name");
+}
+
+/* Not a test: prints how long a barrier takes for each thread count */
+static void print_barrier_costs(thread_pool_t *pool) {
+    long online_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t max_threads = online_cpus > 0 ? (size_t)online_cpus : 1;
+    if (max_threads > BENCH_MAX_THREADS) max_threads = BENCH_MAX_THREADS;
+
+    printf("Barrier cost (ns per wait):\n");
+    printf("  %8s %10s %10s\n", "threads", "spin", "pthread");
+
+    for (size_t threads = 2; threads <= max_threads; threads *= 2) {
+        test_worker_t workers[BENCH_MAX_THREADS] = {0};
+        u64 costs[BARRIER_TYPE_COUNT];
+
+        for (enum barrier_type type = 0; type < BARRIER_TYPE_COUNT; ++type) {
+            for (size_t i = 0; i < threads; ++i) workers[i].type = type;
+
+            spin_barrier_init(&spin_barrier, threads);
+            pthread_barrier_init(&pthread_barrier, NULL, threads);
+
+            u64 clock_start = now_ns();
+            thread_pool_run(pool, wait_many, workers, sizeof (workers[0]), threads);
+            u64 clock_end = now_ns();
+
+            pthread_barrier_destroy(&pthread_barrier);
+            costs[type] = (clock_end - clock_start) / BENCH_WAITS;
+        }
+
+        printf("  %8zu %10lu %10lu\n", threads, costs[BARRIER_SPIN], costs[BARRIER_PTHREAD]);
+    }
+
+    if (max_threads < 2) printf("  Only one CPU available, nothing to measure\n");
+}
+
+int main(void) {
+
+    thread_pool_t pool;
+    thread_pool_init(&pool, BENCH_MAX_THREADS - 1);
+
+    printf("\n--- Start tests: Barrier ---\n");
+    test_phases(&pool, false, "threads never cross a barrier early");
+    test_phases(&pool, true, "threads sleeping on the futex are woken up");
+    test_type_names();
+    print_barrier_costs(&pool);
+
+    printf("--- Summary: Barrier ---\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    printf("\n");
+
+    thread_pool_destroy(&pool);
+
+    return tests_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
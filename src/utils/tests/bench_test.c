@@ -0,0 +1,87 @@
+#include "../bench.h"
+#include "../macros.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+/* Runs a benchmark whose iterations "take" the times given by next_time */
+static bench_stats_t run_fake(const bench_config_t *config, u64 (*next_time)(size_t), size_t *iterations) {
+    bench_t bench;
+    bench_init(&bench, config);
+
+    *iterations = 0;
+    while (bench_next(&bench)) {
+        bench_record(&bench, next_time((*iterations)++));
+    }
+
+    bench_stats_t stats = bench_stats(&bench);
+    bench_free(&bench);
+
+    return stats;
+}
+
+static u64 constant_time(size_t iteration) {
+    UNUSED(iteration);
+    return 1000;
+}
+
+/* Every 10th run is preempted */
+static u64 preempted_time(size_t iteration) {
+    return iteration % 10 == 9 ? 50000 : 1000 + iteration % 3;
+}
+
+/* Swings between 1000 and 3000, never precise enough for a 0.1% target */
+static u64 noisy_time(size_t iteration) {
+    return iteration % 2 ? 1000 : 3000;
+}
+
+/* 1, 2, ..., 100 */
+static u64 ramp_time(size_t iteration) {
+    return iteration + 1;
+}
+
+int main(void) {
+
+    printf("\n--- Start tests: Bench ---\n");
+
+    bench_config_t config = BENCH_DEFAULT_CONFIG;
+    size_t iterations;
+
+    bench_stats_t stats = run_fake(&config, constant_time, &iterations);
+    TEST_ASSERT(stats.runs == config.min_runs && stats.converged, "constant times stop at the minimum of runs");
+    TEST_ASSERT(iterations == config.min_runs + config.warmup_runs, "warmup runs are not measured");
+    TEST_ASSERT(stats.mean == 1000.0 && stats.cv == 0.0 && stats.mad == 0, "constant times have no deviation");
+
+    stats = run_fake(&config, preempted_time, &iterations);
+    TEST_ASSERT(stats.outliers > 0 && stats.outliers * 10 <= stats.runs + 10, "preempted runs are outliers");
+    TEST_ASSERT(stats.mean < 1003.0 && stats.converged, "outliers are left out of the mean");
+    TEST_ASSERT(stats.max == 50000, "outliers are still in the percentiles");
+
+    config.target_precision = 0.001;
+    config.max_runs         = 64;
+    stats = run_fake(&config, noisy_time, &iterations);
+    TEST_ASSERT(stats.runs == 64 && !stats.converged, "stops at max_runs when it does not converge");
+
+    config.max_runs    = 1000;
+    config.max_time_ns = 20000;
+    stats = run_fake(&config, noisy_time, &iterations);
+    TEST_ASSERT(stats.runs == 10, "stops at max_time_ns when it does not converge");
+
+    config = BENCH_DEFAULT_CONFIG;
+    config.warmup_runs = 0;
+    config.min_runs    = 100;
+    config.max_runs    = 100;
+    stats = run_fake(&config, ramp_time, &iterations);
+    TEST_ASSERT(stats.min == 1 && stats.median == 50 && stats.p90 == 90 && stats.p99 == 99 && stats.max == 100,
+                "percentiles");
+    TEST_ASSERT(stats.mad == 25 && stats.outliers == 0, "median absolute deviation");
+
+    printf("--- Summary: Bench ---\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    printf("\n");
+
+    return tests_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
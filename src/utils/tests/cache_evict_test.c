@@ -0,0 +1,43 @@
+#include "../cache_evict.h"
+#include "../macros.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+int main(void) {
+
+    printf("\n--- Start tests: Cache evict ---\n");
+
+    size_t llc = cache_llc_size();
+    TEST_ASSERT(llc >= 1024 * 1024, "last level cache size");
+
+    cache_evictor_t evictor;
+    TEST_ASSERT(cache_evictor_init(&evictor, 4), "allocate the buffer");
+
+    TEST_ASSERT(evictor.size == 4 * evictor.slice_size, "one slice per thread");
+    TEST_ASSERT(evictor.size >= 2 * llc, "twice the last level cache");
+    TEST_ASSERT(evictor.slice_size >= CACHE_EVICT_MIN_SLICE && evictor.slice_size % CACHE_EVICT_LINE == 0,
+                "slices larger than an L2 and made of whole lines");
+
+    /* Every line of the slice is written once, the other slices are untouched */
+    cache_evict_slice(&evictor, 1);
+
+    bool slice_written = true;
+    for (size_t i = 0; i < evictor.slice_size; i += CACHE_EVICT_LINE) {
+        slice_written &= evictor.buffer[evictor.slice_size + i] == 2;
+    }
+    TEST_ASSERT(slice_written, "every line of the slice is written");
+    TEST_ASSERT(evictor.buffer[0] == 1 && evictor.buffer[2 * evictor.slice_size] == 1, "other slices are untouched");
+
+    cache_evictor_free(&evictor);
+    TEST_ASSERT(evictor.buffer == NULL && evictor.size == 0, "free");
+
+    printf("--- Summary: Cache evict ---\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    printf("\n");
+
+    return tests_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
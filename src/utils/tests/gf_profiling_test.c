@@ -0,0 +1,116 @@
+/* Small ring buffers, so the test can wrap them */
+#define GF_PROFILING_THREAD_BUFFER_BYTES (64 * 1024)
+#include "../gf_profiling.c"
+
+#include "../macros.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define THREAD_COUNT 4
+#define CALL_COUNT 1000
+
+/* Stand-ins for the instrumented functions, the hooks are called by hand */
+static void function_a(void) {}
+static void function_b(void) {}
+
+typedef struct {
+    size_t             calls;
+    void              *function;
+    GfProfilingThread *thread;
+} worker_args_t;
+
+/* Not instrumented in the _dbg build, the only events are the ones of the test */
+__attribute__((no_instrument_function))
+static void *worker(void *arg) {
+    worker_args_t *args = arg;
+    for (size_t i = 0; i < args->calls; ++i) {
+        __cyg_profile_func_enter(args->function, NULL);
+        __cyg_profile_func_exit(args->function, NULL);
+    }
+    args->thread = gfProfilingThisThread;
+    return NULL;
+}
+
+/* Enter and exit events alternate, all of function, in time order */
+static bool events_valid(GfProfilingThread *thread, void *function) {
+    size_t count = GfProfilingThreadEntryCount(thread);
+    u64 previous = 0;
+    for (size_t i = 0; i < count; ++i) {
+        GfProfilingEntry *entry = GfProfilingThreadEntry(thread, i);
+        u64 ticks   = entry->timeStamp & ~(1ULL << 63);
+        bool exited = entry->timeStamp >> 63;
+        if (entry->thisFunction != function || exited != (i & 1) || ticks < previous) return false;
+        previous = ticks;
+    }
+    return true;
+}
+
+__attribute__((no_instrument_function))
+int main(void) {
+
+    printf("\n--- Start tests: GF profiling ---\n");
+
+    __cyg_profile_func_enter((void *)function_a, NULL);
+    TEST_ASSERT(gfProfilingThreads == NULL, "nothing recorded before start");
+
+    GfProfilingStart();
+
+    /* The last thread writes past its ring buffer */
+    pthread_t threads[THREAD_COUNT];
+    worker_args_t args[THREAD_COUNT];
+    for (size_t i = 0; i < THREAD_COUNT; ++i) {
+        args[i] = (worker_args_t) {
+            .calls    = i == THREAD_COUNT - 1 ? gfProfilingBufferSize : CALL_COUNT,
+            .function = i & 1 ? (void *)function_b : (void *)function_a,
+        };
+        pthread_create(&threads[i], NULL, worker, &args[i]);
+    }
+    for (size_t i = 0; i < THREAD_COUNT; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    GfProfilingStop();
+
+    TEST_ASSERT(gfProfilingThreadCount == THREAD_COUNT, "one buffer per thread");
+
+    bool ids_distinct = true, events_ok = true, counts_ok = true;
+    for (size_t i = 0; i < THREAD_COUNT; ++i) {
+        GfProfilingThread *thread = args[i].thread;
+        if (!thread) {
+            ids_distinct = false;
+            continue;
+        }
+        for (size_t j = 0; j < i; ++j) {
+            ids_distinct &= args[j].thread && args[j].thread->threadId != thread->threadId;
+        }
+        ids_distinct &= thread->threadId != (u32)syscall(SYS_gettid);
+        events_ok    &= events_valid(thread, args[i].function);
+        counts_ok    &= thread->position == 2 * args[i].calls;
+    }
+    TEST_ASSERT(ids_distinct, "thread ids recorded and distinct");
+    TEST_ASSERT(counts_ok, "every event counted");
+    TEST_ASSERT(events_ok, "events of each thread intact");
+
+    GfProfilingThread *wrapped = args[THREAD_COUNT - 1].thread;
+    TEST_ASSERT(wrapped && GfProfilingThreadEntryCount(wrapped) == gfProfilingBufferSize,
+                "a full ring buffer keeps the latest events");
+
+    /* Stopped: the main thread gets no buffer */
+    __cyg_profile_func_enter((void *)function_a, NULL);
+    TEST_ASSERT(gfProfilingThreadCount == THREAD_COUNT, "nothing recorded after stop");
+
+    GfProfilingStart();
+    GfProfilingStop();
+    TEST_ASSERT(wrapped && GfProfilingThreadEntryCount(wrapped) == 0, "start discards the previous events");
+
+    printf("--- Summary: GF profiling ---\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    printf("\n");
+
+    return tests_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,154 @@
+/* Small chunks, so lines cross chunk boundaries and some lines are longer than a chunk */
+#define INPUT_STREAM_CHUNK_SIZE 64
+
+#ifndef ALLOC_STD_IMPL
+#define ALLOC_STD_IMPL
+#endif
+#define ALLOC_ARENA_IMPL
+#include "../allocator.h"
+#include "../input_stream.h"
+#include "../thread_pool.h"
+#include "../macros.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_THREADS 4
+#define TEST_LINES   5000
+#define TEST_PATH    "/tmp/input_stream_test.txt"
+
+typedef struct {
+    input_stream_t *stream;
+    string_t        input;
+    atomic_size_t  *cursor;
+    u64             line_count;
+    u64             checksum;
+    bool            complete_lines;
+} test_worker_t;
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static u64 expected_checksum;
+
+/* Line i is the number i, repeated i % 37 + 1 times, lines 1000 and 2000 are much longer than a chunk */
+static void write_test_file(void) {
+    FILE *file = fopen(TEST_PATH, "w");
+
+    expected_checksum = 0;
+    for (u64 i = 0; i < TEST_LINES; ++i) {
+        size_t repeats = (i == 1000 || i == 2000) ? 200 : i % 37 + 1;
+        for (size_t r = 0; r < repeats; ++r) fprintf(file, "%lu ", i);
+        fprintf(file, "\n");
+        expected_checksum += i * repeats;
+    }
+
+    fclose(file);
+}
+
+/* Sums every number of each line */
+static void *consume_chunks(void *arg) {
+    test_worker_t *worker = arg;
+
+    worker->complete_lines = true;
+
+    for (;;) {
+        size_t chunk_idx = atomic_fetch_add(worker->cursor, 1);
+
+        string_t chunk;
+        if (!input_stream_chunk(worker->stream, worker->input, chunk_idx, &chunk)) break;
+
+        if (chunk.count > 0 && chunk.chars[chunk.count - 1] != '\n') worker->complete_lines = false;
+
+        u64 number = 0;
+        for (size_t i = 0; i < chunk.count; ++i) {
+            char c = chunk.chars[i];
+            if (c >= '0' && c <= '9') {
+                number = number * 10 + (c - '0');
+            } else {
+                worker->checksum += number;
+                number = 0;
+                if (c == '\n') worker->line_count++;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static void run_consumers(thread_pool_t *pool, input_stream_t *stream, string_t input, const char *label) {
+    atomic_size_t cursor = 0;
+    test_worker_t workers[TEST_THREADS];
+
+    for (size_t i = 0; i < TEST_THREADS; ++i) {
+        workers[i] = (test_worker_t) { .stream = stream, .input = input, .cursor = &cursor };
+    }
+
+    thread_pool_run(pool, consume_chunks, workers, sizeof (workers[0]), TEST_THREADS);
+
+    u64  lines    = 0;
+    u64  checksum = 0;
+    bool complete = true;
+    for (size_t i = 0; i < TEST_THREADS; ++i) {
+        lines    += workers[i].line_count;
+        checksum += workers[i].checksum;
+        complete &= workers[i].complete_lines;
+    }
+
+    char msg[128];
+    snprintf(msg, sizeof (msg), "%s: every line read once", label);
+    TEST_ASSERT(lines == TEST_LINES && checksum == expected_checksum, msg);
+    snprintf(msg, sizeof (msg), "%s: chunks end at line ends", label);
+    TEST_ASSERT(complete, msg);
+}
+
+int main(void) {
+
+    thread_pool_t pool;
+    thread_pool_init(&pool, TEST_THREADS - 1);
+
+    printf("\n--- Start tests: Input stream ---\n");
+
+    write_test_file();
+
+    input_stream_t stream;
+    TEST_ASSERT(input_stream_open(&stream, TEST_PATH, &global_std_allocator), "open the input");
+    TEST_ASSERT(!input_stream_open(&(input_stream_t){0}, "/nonexistent/input.txt", &global_std_allocator), "missing input");
+
+    /* The buffer does not fit in the arena: the file must not stay open */
+    u8 tiny_buffer[256];
+    allocator_t tiny_arena = { .interface = &arena_interface, .alloc_ctx = arena_from_buf(tiny_buffer, sizeof (tiny_buffer)) };
+    input_stream_t failed;
+    bool opened = input_stream_open(&failed, TEST_PATH, &tiny_arena);
+    TEST_ASSERT(!opened && failed.fd == -1, "failed allocation closes the file");
+
+    string_t input = input_stream_string(&stream);
+
+    input_stream_start(&stream);
+    run_consumers(&pool, &stream, input, "streamed");
+    input_stream_join(&stream);
+
+    TEST_ASSERT(atomic_load(&stream.loaded) == stream.size, "whole input loaded");
+
+    /* Same chunks from the input once it is loaded */
+    run_consumers(&pool, NULL, input, "loaded");
+
+    /* The last line has no '\n' */
+    string_t no_newline = { .chars = "1\n22\n333", .count = 8 };
+    string_t chunk;
+    bool last_line_ok = input_stream_chunk(NULL, no_newline, 0, &chunk) && chunk.count == 8
+        && !input_stream_chunk(NULL, no_newline, 1, &chunk);
+    TEST_ASSERT(last_line_ok, "last line without a newline");
+
+    allocator_free(&global_std_allocator, stream.buffer, stream.size + 1);
+    remove(TEST_PATH);
+
+    printf("--- Summary: Input stream ---\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    printf("\n");
+
+    thread_pool_destroy(&pool);
+
+    return tests_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
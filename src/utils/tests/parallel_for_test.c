@@ -0,0 +1,167 @@
+#include "../parallel_for.h"
+#include "../thread_pool.h"
+#include "../macros.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_THREADS 4
+#define TEST_ITEMS   1000
+
+typedef struct {
+    parallel_for_t *loop;
+    size_t          thread_idx;
+    u64             weight;
+} test_worker_t;
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static u64           prefix[TEST_ITEMS + 1];
+static u8            visits[TEST_ITEMS];
+static parallel_for_t loop;
+
+/* A few items are much more expensive than the rest */
+static u64 skewed_cost(void *arg, size_t idx) {
+    UNUSED(arg);
+    return idx % 100 == 0 ? 1000 : 1;
+}
+
+static void *visit_items(void *arg) {
+    test_worker_t *worker = arg;
+
+    size_t start;
+    size_t end;
+    parallel_for_iter_t it = parallel_for_begin(worker->loop, worker->thread_idx);
+    while (parallel_for_next(&it, &start, &end)) {
+        for (size_t i = start; i < end; ++i) {
+            visits[i]++;
+            worker->weight += prefix[i + 1] - prefix[i];
+        }
+    }
+
+    return NULL;
+}
+
+static bool every_item_visited_once(void) {
+    bool once = true;
+    for (size_t i = 0; i < TEST_ITEMS; ++i) once &= visits[i] == 1;
+    return once;
+}
+
+static void test_split_weights(void) {
+    /* Total weight 16, the heavy item should end up alone */
+    u64 weights[] = { 0, 1, 2, 3, 4, 12, 13, 14, 16 };
+    size_t start;
+    size_t end;
+
+    split_weights_evenly(0, 2, weights, 8, &start, &end);
+    TEST_ASSERT(start == 0 && end == 5, "first part takes the items before the heavy one");
+    split_weights_evenly(1, 2, weights, 8, &start, &end);
+    TEST_ASSERT(start == 5 && end == 8, "second part takes the rest");
+
+    bool contiguous = true;
+    size_t prev_end = 0;
+    for (size_t i = 0; i < 5; ++i) {
+        split_weights_evenly(i, 5, weights, 8, &start, &end);
+        contiguous &= start == prev_end && start <= end;
+        prev_end = end;
+    }
+    TEST_ASSERT(contiguous && prev_end == 8, "parts are contiguous and cover every item");
+}
+
+static void test_prefix(void) {
+    u64 total = parallel_for_prefix(skewed_cost, NULL, TEST_ITEMS, prefix);
+    TEST_ASSERT(prefix[0] == 0 && total == 10 * 1000 + 990, "prefix sums of the cost function");
+}
+
+static void run_loop(thread_pool_t *pool, enum parallel_schedule schedule, size_t grain, test_worker_t *workers) {
+    memset(visits, 0, sizeof (visits));
+    parallel_for_init(&loop, schedule, TEST_ITEMS, prefix, grain, TEST_THREADS);
+
+    for (size_t i = 0; i < TEST_THREADS; ++i) {
+        workers[i] = (test_worker_t) { .loop = &loop, .thread_idx = i };
+    }
+
+    thread_pool_run(pool, visit_items, workers, sizeof (workers[0]), TEST_THREADS);
+}
+
+static void test_static(thread_pool_t *pool) {
+    test_worker_t workers[TEST_THREADS];
+    run_loop(pool, PARALLEL_STATIC, 1, workers);
+
+    TEST_ASSERT(every_item_visited_once(), "static: every item visited once");
+
+    /* Each thread gets a quarter of the weight, give or take the heaviest item */
+    bool balanced = true;
+    for (size_t i = 0; i < TEST_THREADS; ++i) {
+        i64 diff = (i64)workers[i].weight - (i64)(prefix[TEST_ITEMS] / TEST_THREADS);
+        balanced &= diff < 1000 && diff > -1000;
+    }
+    TEST_ASSERT(balanced, "static: chunks have the same weight");
+
+    /* Boundaries at multiples of the grain */
+    parallel_for_init(&loop, PARALLEL_STATIC, TEST_ITEMS, prefix, 64, TEST_THREADS);
+    bool aligned = true;
+    for (size_t i = 0; i < TEST_THREADS; ++i) {
+        size_t start = 0;
+        size_t end   = 0;
+        parallel_for_iter_t it = parallel_for_begin(&loop, i);
+        if (parallel_for_next(&it, &start, &end)) {
+            aligned &= start % 64 == 0 && (end % 64 == 0 || end == TEST_ITEMS);
+        }
+        aligned &= !parallel_for_next(&it, &start, &end);
+    }
+    TEST_ASSERT(aligned, "static: one chunk per thread, aligned to the grain");
+
+    run_loop(pool, PARALLEL_STATIC, 64, workers);
+    TEST_ASSERT(every_item_visited_once(), "static: every item visited once with a grain");
+}
+
+static void test_dynamic(thread_pool_t *pool) {
+    test_worker_t workers[TEST_THREADS];
+
+    run_loop(pool, PARALLEL_DYNAMIC, 1, workers);
+    TEST_ASSERT(every_item_visited_once(), "dynamic: every item visited once");
+
+    run_loop(pool, PARALLEL_DYNAMIC, 7, workers);
+    TEST_ASSERT(every_item_visited_once(), "dynamic: every item visited once with a grain");
+
+    memset(visits, 0, sizeof (visits));
+    parallel_for_init(&loop, PARALLEL_DYNAMIC, TEST_ITEMS, NULL, 10, TEST_THREADS);
+    size_t start;
+    size_t end;
+    size_t chunks = 0;
+    bool grain_respected = true;
+    parallel_for_iter_t it = parallel_for_begin(&loop, 0);
+    while (parallel_for_next(&it, &start, &end)) {
+        grain_respected &= end - start >= 10 || end == TEST_ITEMS;
+        for (size_t i = start; i < end; ++i) visits[i]++;
+        ++chunks;
+    }
+    TEST_ASSERT(every_item_visited_once() && grain_respected, "dynamic: equal weights");
+    /* The chunk weight is rounded down, so there may be one more small chunk at the end */
+    size_t target_chunks = TEST_THREADS * PARALLEL_FOR_CHUNKS_PER_THREAD;
+    TEST_ASSERT(chunks >= target_chunks && chunks <= target_chunks + 1, "dynamic: chunks per thread");
+}
+
+int main(void) {
+
+    thread_pool_t pool;
+    thread_pool_init(&pool, TEST_THREADS - 1);
+
+    printf("\n--- Start tests: Parallel for ---\n");
+    test_split_weights();
+    test_prefix();
+    test_static(&pool);
+    test_dynamic(&pool);
+
+    printf("--- Summary: Parallel for ---\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    printf("\n");
+
+    thread_pool_destroy(&pool);
+
+    return tests_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,63 @@
+#include "../perf_counters.h"
+#include "../macros.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+/* Enough work for every counter to move */
+static u64 busy_work(void) {
+    volatile u64 sum = 0;
+    for (u64 i = 0; i < 2000000; ++i) sum += i * i;
+    return sum;
+}
+
+int main(void) {
+
+    printf("\n--- Start tests: Perf counters ---\n");
+
+    perf_group_t group;
+    bool opened = perf_group_open(&group);
+
+    /* Counters are often not permitted (containers, VMs), which must be reported, not fatal */
+    TEST_ASSERT(opened || (group.error != 0 && group.opened == 0), "open or report why not");
+
+    if (opened) {
+        perf_sample_t start;
+        perf_sample_t end;
+        perf_sample_t delta;
+
+        TEST_ASSERT(perf_group_read(&group, &start), "read");
+        busy_work();
+        TEST_ASSERT(perf_group_read(&group, &end), "read again");
+
+        perf_sample_delta(&end, &start, &delta);
+        TEST_ASSERT(delta.available == start.available && delta.available != 0, "counters in both samples");
+
+        bool all_moved = true;
+        for (u32 i = 0; i < PERF_COUNTER_COUNT; ++i) {
+            if (i == PERF_CACHE_MISSES) continue;
+            if (perf_sample_has(&delta, i) && delta.values[i] == 0) all_moved = false;
+        }
+        TEST_ASSERT(all_moved, "counters count the work");
+
+        if (perf_sample_has(&delta, PERF_INSTRUCTIONS)) {
+            TEST_ASSERT(delta.values[PERF_INSTRUCTIONS] >= 2000000, "at least one instruction per iteration");
+        }
+    } else {
+        printf("Counters not available: %s\n", strerror(group.error));
+    }
+
+    perf_group_close(&group);
+
+    perf_sample_t sample;
+    TEST_ASSERT(!perf_group_read(&group, &sample) && sample.available == 0, "read after close");
+
+    printf("--- Summary: Perf counters ---\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    printf("\n");
+
+    return tests_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
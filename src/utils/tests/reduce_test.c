@@ -0,0 +1,78 @@
+#include "../reduce.h"
+#include "../thread_pool.h"
+#include "../macros.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST_THREADS 4
+#define TEST_ITEMS   100000
+
+typedef struct {
+    size_t thread_idx;
+} test_worker_t;
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static reduction_t reduction;
+
+static u64 xor_op(u64 acc, u64 value) {
+    return acc ^ value;
+}
+
+/* Each thread sums its share of 1..TEST_ITEMS and publishes it once */
+static void *sum_items(void *arg) {
+    test_worker_t *worker = arg;
+
+    u64 local_sum = 0;
+    for (u64 i = worker->thread_idx + 1; i <= TEST_ITEMS; i += TEST_THREADS) local_sum += i;
+
+    reduce_store(&reduction, worker->thread_idx, local_sum);
+    return NULL;
+}
+
+static void test_slots_padded(void) {
+    TEST_ASSERT(sizeof (reduce_slot_t) == 64, "slots take a whole cache line");
+    TEST_ASSERT((uintptr_t)&reduction.slots[1] - (uintptr_t)&reduction.slots[0] == 64, "slots do not share cache lines");
+}
+
+static void test_parallel_sum(void) {
+    thread_pool_t pool;
+    thread_pool_init(&pool, TEST_THREADS - 1);
+
+    test_worker_t workers[TEST_THREADS];
+    for (size_t i = 0; i < TEST_THREADS; ++i) workers[i].thread_idx = i;
+
+    thread_pool_run(&pool, sum_items, workers, sizeof (workers[0]), TEST_THREADS);
+
+    TEST_ASSERT(reduce_sum(&reduction, TEST_THREADS) == (u64)TEST_ITEMS * (TEST_ITEMS + 1) / 2, "parallel sum");
+
+    thread_pool_destroy(&pool);
+}
+
+static void test_operations(void) {
+    u64 values[] = { 7, 3, 12, 5 };
+    for (size_t i = 0; i < 4; ++i) reduce_store(&reduction, i, values[i]);
+
+    TEST_ASSERT(reduce_sum(&reduction, 4) == 27, "sum");
+    TEST_ASSERT(reduce_min(&reduction, 4) == 3, "min");
+    TEST_ASSERT(reduce_max(&reduction, 4) == 12, "max");
+    TEST_ASSERT(reduce_combine(&reduction, 4, xor_op, 0) == (7 ^ 3 ^ 12 ^ 5), "custom operation");
+    TEST_ASSERT(reduce_sum(&reduction, 2) == 10, "only the first thread_count slots are combined");
+    TEST_ASSERT(reduce_min(&reduction, 0) == UINT64_MAX, "identity without threads");
+}
+
+int main(void) {
+
+    printf("\n--- Start tests: Reduce ---\n");
+    test_slots_padded();
+    test_parallel_sum();
+    test_operations();
+
+    printf("--- Summary: Reduce ---\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    printf("\n");
+
+    return tests_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,151 @@
+#include "../thread_pool.h"
+#include "../macros.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TEST_WORKERS 7
+
+typedef struct {
+    u64    runs;
+    u64    last_job;
+} test_task_t;
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static u64 current_job;
+
+static void *record_task(void *arg) {
+    test_task_t *task = arg;
+    task->runs++;
+    task->last_job = current_job;
+    return NULL;
+}
+
+/* Every task of a job must run exactly once */
+static void test_single_job(void) {
+    thread_pool_t pool;
+    test_task_t tasks[TEST_WORKERS + 1] = {0};
+
+    TEST_ASSERT(thread_pool_init(&pool, TEST_WORKERS), "pool started");
+
+    current_job = 1;
+    thread_pool_run(&pool, record_task, tasks, sizeof (tasks[0]), TEST_WORKERS + 1);
+
+    bool all_ran_once = true;
+    for (size_t i = 0; i < TEST_WORKERS + 1; ++i) {
+        all_ran_once &= tasks[i].runs == 1 && tasks[i].last_job == 1;
+    }
+    TEST_ASSERT(all_ran_once, "every task ran exactly once");
+
+    thread_pool_destroy(&pool);
+    TEST_ASSERT(pool.worker_count == 0, "pool destroyed");
+}
+
+/* Jobs with fewer tasks than workers must not wake the remaining workers */
+static void test_partial_jobs(void) {
+    thread_pool_t pool;
+    test_task_t tasks[TEST_WORKERS + 1] = {0};
+
+    thread_pool_init(&pool, TEST_WORKERS);
+
+    u64 expected_runs[TEST_WORKERS + 1] = {0};
+    for (u64 job = 1; job <= 1000; ++job) {
+        size_t task_count = 1 + job % (TEST_WORKERS + 1);
+
+        current_job = job;
+        thread_pool_run(&pool, record_task, tasks, sizeof (tasks[0]), task_count);
+
+        for (size_t i = 0; i < task_count; ++i) expected_runs[i]++;
+    }
+
+    bool runs_match = true;
+    for (size_t i = 0; i < TEST_WORKERS + 1; ++i) {
+        runs_match &= tasks[i].runs == expected_runs[i];
+    }
+    TEST_ASSERT(runs_match, "task counts match across 1000 jobs");
+    TEST_ASSERT(tasks[0].last_job == 1000, "calling thread ran the last job");
+
+    thread_pool_destroy(&pool);
+}
+
+/* Workers that parked (slept on the futex) must still pick up new work */
+static void test_wake_after_sleep(void) {
+    thread_pool_t pool;
+    test_task_t tasks[TEST_WORKERS + 1] = {0};
+
+    thread_pool_init(&pool, TEST_WORKERS);
+
+    for (u64 job = 1; job <= 3; ++job) {
+        /* Long enough for every worker to give up spinning */
+        struct timespec wait = { .tv_sec = 0, .tv_nsec = 20 * 1000 * 1000 };
+        nanosleep(&wait, NULL);
+
+        current_job = job;
+        thread_pool_run(&pool, record_task, tasks, sizeof (tasks[0]), TEST_WORKERS + 1);
+    }
+
+    bool all_ran = true;
+    for (size_t i = 0; i < TEST_WORKERS + 1; ++i) {
+        all_ran &= tasks[i].runs == 3 && tasks[i].last_job == 3;
+    }
+    TEST_ASSERT(all_ran, "parked workers woke up for every job");
+
+    thread_pool_destroy(&pool);
+}
+
+/* Threads of the process, from /proc/self/task */
+static size_t thread_count(void) {
+    size_t count = 0;
+    DIR *tasks = opendir("/proc/self/task");
+    if (!tasks) return 0;
+    for (struct dirent *entry; (entry = readdir(tasks));) count += entry->d_name[0] != '.';
+    closedir(tasks);
+    return count;
+}
+
+/* The address space only has room for a few stacks, so pthread_create fails partway */
+static void test_partial_start(void) {
+    thread_pool_t pool;
+
+    size_t pages = 0;
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if (!statm || fscanf(statm, "%zu", &pages) != 1) pages = 0;
+    if (statm) fclose(statm);
+
+    struct rlimit original;
+    getrlimit(RLIMIT_AS, &original);
+
+    /* Each stack reserves 8 MB by default */
+    struct rlimit limited = original;
+    limited.rlim_cur = pages * sysconf(_SC_PAGESIZE) + 20 * 1024 * 1024;
+    setrlimit(RLIMIT_AS, &limited);
+
+    bool started = thread_pool_init(&pool, THREAD_POOL_MAX_THREADS);
+
+    setrlimit(RLIMIT_AS, &original);
+
+    TEST_ASSERT(!started && pool.worker_count == 0, "failed start leaves no workers");
+    TEST_ASSERT(thread_count() == 1, "the workers started before the failure were joined");
+}
+
+int main(void) {
+
+    printf("\n--- Start tests: Thread pool ---\n");
+    test_single_job();
+    test_partial_jobs();
+    test_wake_after_sleep();
+    test_partial_start();
+
+    printf("--- Summary: Thread pool ---\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    printf("\n");
+
+    return tests_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+#include "../timer.h"
+#include "../macros.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+/* Measures an interval of about 10 ms with both clocks, returns the error in ppm */
+static u64 interval_error_ppm(void) {
+
+    u64 start_ns   = timer_clock_ns();
+    u64 start_tick = timer_ticks();
+    while (timer_clock_ns() - start_ns < 10 * 1000 * 1000);
+    u64 end_tick   = timer_ticks_end();
+    u64 end_ns     = timer_clock_ns();
+
+    u64 clock_ns = end_ns - start_ns;
+    u64 timer_ns = timer_ticks_to_ns(end_tick - start_tick);
+    u64 diff     = clock_ns > timer_ns ? clock_ns - timer_ns : timer_ns - clock_ns;
+
+    return diff * 1000000 / clock_ns;
+}
+
+/* First read of the timer from several threads at once */
+static void *read_timer(void *arg) {
+    *(u64 *)arg = timer_ticks_to_ns(timer_ticks());
+    return NULL;
+}
+
+int main(void) {
+
+    printf("\n--- Start tests: Timer ---\n");
+
+    timer_init();
+    printf("Source: %s (%lu ticks/s)\n", timer_source_name(), timer_state.frequency);
+
+    TEST_ASSERT(timer_state.initialized, "initialized");
+    TEST_ASSERT(timer_state.frequency > 0 && timer_state.mult > 0, "calibrated");
+
+    bool monotonic = true;
+    u64 previous = timer_ticks();
+    for (int i = 0; i < 100000; ++i) {
+        u64 now = timer_ticks();
+        monotonic &= now >= previous;
+        previous = now;
+    }
+    TEST_ASSERT(monotonic, "ticks never go back");
+
+    /* Within 1%, the calibration is much better but a VM can be descheduled mid-interval */
+    TEST_ASSERT(interval_error_ppm() < 10000, "agrees with CLOCK_MONOTONIC");
+
+    /* Lazy initialization: one of the racing threads calibrates, the others wait for it */
+    timer_state = (timer_state_t) {0};
+
+    pthread_t threads[4];
+    u64       reads[4] = {0};
+    for (int i = 0; i < 4; ++i) pthread_create(&threads[i], NULL, read_timer, &reads[i]);
+    for (int i = 0; i < 4; ++i) pthread_join(threads[i], NULL);
+
+    bool all_read = true;
+    for (int i = 0; i < 4; ++i) all_read &= reads[i] > 0;
+    TEST_ASSERT(timer_state.initialized && timer_state.frequency > 0 && all_read, "first read from several threads");
+
+    /* Forced fallback, the ticks are ns */
+    setenv("AOC_TIMER", "clock", 1);
+    timer_state = (timer_state_t) {0};
+    timer_init();
+
+    TEST_ASSERT(timer_state.source == TIMER_CLOCK, "AOC_TIMER=clock falls back to clock_gettime");
+    TEST_ASSERT(timer_state.frequency == 1000000000ULL && timer_ticks_to_ns(12345) == 12345, "clock ticks are ns");
+    TEST_ASSERT(interval_error_ppm() < 10000, "fallback agrees with CLOCK_MONOTONIC");
+
+    printf("--- Summary: Timer ---\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    printf("\n");
+
+    return tests_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
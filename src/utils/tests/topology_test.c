@@ -0,0 +1,122 @@
+#define _GNU_SOURCE
+#include "../topology.h"
+#include "../macros.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+/*
+ * Fake 2 CCD machine with 2 cores per CCD and SMT, numbered like Linux does on Zen:
+ * CPUs 0-3 are the first hardware thread of each core and 4-7 their siblings.
+ *
+ *   CCD 0: core 0 = {0, 4}, core 1 = {1, 5}
+ *   CCD 1: core 2 = {2, 6}, core 3 = {3, 7}
+ */
+static void build_fake_topology(cpu_topology_t *topo) {
+    u16 first_sibling[] = { 0, 1, 2, 3, 0, 1, 2, 3 };
+    u16 first_l3_cpu[]  = { 0, 0, 2, 2, 0, 0, 2, 2 };
+
+    topo->cpu_count = 8;
+    for (u16 i = 0; i < 8; ++i) topo->cpus[i].cpu = i;
+
+    topology_build(topo, first_sibling, first_l3_cpu);
+}
+
+static bool order_equals(const u16 *order, const u16 *expected, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (order[i] != expected[i]) return false;
+    }
+    return true;
+}
+
+static void test_parse_cpu_list(void) {
+    u16 cpus[16];
+
+    size_t count = topology_parse_cpu_list(string_from_cstr("0-3,8,10-11\n"), cpus, 16);
+    u16 expected[] = { 0, 1, 2, 3, 8, 10, 11 };
+
+    TEST_ASSERT(count == 7 && order_equals(cpus, expected, 7), "parse cpu list with ranges");
+    TEST_ASSERT(topology_parse_cpu_list(string_from_cstr("5"), cpus, 16) == 1 && cpus[0] == 5, "parse single cpu");
+    TEST_ASSERT(topology_parse_cpu_list(string_from_cstr("0-31"), cpus, 16) == 16, "parse respects max cpus");
+}
+
+static void test_build(void) {
+    cpu_topology_t topo;
+    build_fake_topology(&topo);
+
+    TEST_ASSERT(topo.l3_domain_count == 2, "two L3 domains found");
+    TEST_ASSERT(topo.cpus[4].smt_rank == 1 && topo.cpus[0].smt_rank == 0, "SMT siblings ranked");
+    TEST_ASSERT(topo.cpus[3].l3_domain == 1 && topo.cpus[5].l3_domain == 0, "CPUs assigned to their CCD");
+}
+
+static void test_policies(void) {
+    cpu_topology_t topo;
+    build_fake_topology(&topo);
+
+    u16 order[TOPOLOGY_MAX_CPUS];
+
+    TEST_ASSERT(topology_order(&topo, PIN_NONE, order) == 0, "no order when not pinning");
+
+    u16 physical_first[] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+    topology_order(&topo, PIN_PHYSICAL_FIRST, order);
+    TEST_ASSERT(order_equals(order, physical_first, 8), "physical-first order");
+
+    u16 same_ccd[] = { 0, 1, 4, 5, 2, 3, 6, 7 };
+    topology_order(&topo, PIN_SAME_CCD, order);
+    TEST_ASSERT(order_equals(order, same_ccd, 8), "same-ccd order");
+
+    u16 spread[] = { 0, 2, 1, 3, 4, 6, 5, 7 };
+    topology_order(&topo, PIN_SPREAD, order);
+    TEST_ASSERT(order_equals(order, spread, 8), "spread order");
+}
+
+static void test_policy_names(void) {
+    bool names_ok = true;
+    for (enum pin_policy policy = 0; policy < PIN_POLICY_COUNT; ++policy) {
+        names_ok &= pin_policy_from_cstr(pin_policy_names[policy]) == policy;
+    }
+    TEST_ASSERT(names_ok, "policy names round trip");
+    TEST_ASSERT(pin_policy_from_cstr("bogus") == PIN_POLICY_COUNT, "unknown policy name");
+}
+
+static void test_read_sysfs(void) {
+    cpu_topology_t topo;
+
+    if (!topology_read(&topo)) {
+        printf("sysfs topology not available, skipping\n");
+        return;
+    }
+
+    u16 order[TOPOLOGY_MAX_CPUS];
+    size_t count = topology_order(&topo, PIN_PHYSICAL_FIRST, order);
+
+    bool is_permutation = count == topo.cpu_count;
+    for (size_t i = 0; i < count; ++i) {
+        bool found = false;
+        for (size_t j = 0; j < topo.cpu_count; ++j) found |= topo.cpus[j].cpu == order[i];
+        is_permutation &= found;
+    }
+
+    TEST_ASSERT(topo.cpu_count > 0, "read topology from sysfs");
+    TEST_ASSERT(is_permutation, "order contains every CPU");
+    TEST_ASSERT(topology_pin_thread(pthread_self(), order[0]), "pin the current thread");
+}
+
+int main(void) {
+
+    printf("\n--- Start tests: Topology ---\n");
+    test_parse_cpu_list();
+    test_build();
+    test_policies();
+    test_policy_names();
+    test_read_sysfs();
+
+    printf("--- Summary: Topology ---\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    printf("\n");
+
+    return tests_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,94 @@
+#include "../unix_socket.h"
+#include "../macros.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_PATH "/tmp/unix_socket_test.sock"
+
+/* Bigger than the socket buffers, so sends and receives are split */
+#define BIG_MESSAGE_SIZE (1024 * 1024)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static int listener;
+
+/* Echoes every message back, until the client disconnects */
+static void *echo_server(void *arg) {
+    UNUSED(arg);
+
+    int client = accept(listener, NULL, NULL);
+
+    u64 size;
+    while (unix_socket_recv_size(client, &size)) {
+        char *payload = malloc(size);
+        bool ok = unix_socket_recv_all(client, payload, size) && unix_socket_send_message(client, payload, size);
+        free(payload);
+        if (!ok) break;
+    }
+
+    close(client);
+    return NULL;
+}
+
+static bool round_trip(int fd, const char *data, u64 size) {
+    u64 response_size;
+    if (!unix_socket_send_message(fd, data, size) || !unix_socket_recv_size(fd, &response_size)) return false;
+    if (response_size != size) return false;
+
+    char *response = malloc(size + 1);
+    bool ok = unix_socket_recv_all(fd, response, size) && memcmp(response, data, size) == 0;
+    free(response);
+
+    return ok;
+}
+
+int main(void) {
+
+    printf("\n--- Start tests: Unix socket ---\n");
+
+    listener = unix_socket_listen(TEST_PATH);
+    TEST_ASSERT(listener >= 0, "listen");
+
+    /* A stale socket file is replaced */
+    int second_listener = unix_socket_listen(TEST_PATH);
+    TEST_ASSERT(second_listener >= 0, "listen over a stale socket file");
+    close(listener);
+    listener = second_listener;
+
+    pthread_t server;
+    pthread_create(&server, NULL, echo_server, NULL);
+
+    int fd = unix_socket_connect(TEST_PATH);
+    TEST_ASSERT(fd >= 0, "connect");
+
+    TEST_ASSERT(round_trip(fd, "R10\nL5\n", 7), "small message");
+    TEST_ASSERT(round_trip(fd, "", 0), "empty message");
+
+    char *big = malloc(BIG_MESSAGE_SIZE);
+    for (size_t i = 0; i < BIG_MESSAGE_SIZE; ++i) big[i] = (char)(i * 31);
+    TEST_ASSERT(round_trip(fd, big, BIG_MESSAGE_SIZE), "message larger than the socket buffers");
+    free(big);
+
+    close(fd);
+    pthread_join(server, NULL);
+
+    TEST_ASSERT(unix_socket_connect("/nonexistent/dir/test.sock") < 0, "connect to a missing socket");
+
+    char long_path[256];
+    memset(long_path, 'a', sizeof (long_path) - 1);
+    long_path[sizeof (long_path) - 1] = '\0';
+    TEST_ASSERT(unix_socket_listen(long_path) < 0, "path too long for a socket");
+
+    close(listener);
+    unlink(TEST_PATH);
+
+    printf("--- Summary: Unix socket ---\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    printf("\n");
+
+    return tests_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
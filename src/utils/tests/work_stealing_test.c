@@ -0,0 +1,176 @@
+#include "../allocator.h"
+#include "../work_stealing.h"
+#include "../thread_pool.h"
+#include "../macros.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST_THREADS 4
+
+typedef struct {
+    ws_scheduler_t *sched;
+    size_t          thread_idx;
+    u64             grain;
+    u64             sum;
+    u64             items;
+    u64             tasks;
+} test_worker_t;
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static ws_scheduler_t sched;
+
+static void *sum_ranges(void *arg) {
+    test_worker_t *worker = arg;
+
+    ws_task_t task;
+    while (ws_next(worker->sched, worker->thread_idx, &task)) {
+        ws_split(worker->sched, worker->thread_idx, &task, worker->grain);
+
+        for (u64 i = task.start; i <= task.end; ++i) {
+            worker->sum += i;
+            worker->items++;
+        }
+        worker->tasks++;
+
+        ws_task_done(worker->sched);
+    }
+
+    return NULL;
+}
+
+static void test_push_pop(void) {
+    ws_init(&sched, 1, ws_deque_capacity(2, 1), &global_std_allocator);
+
+    ws_push(&sched, 0, (ws_task_t){ .start = 1, .end = 1 });
+    ws_push(&sched, 0, (ws_task_t){ .start = 2, .end = 2 });
+
+    ws_task_t task;
+    TEST_ASSERT(ws_next(&sched, 0, &task) && task.start == 2, "owner pops the newest task");
+    ws_task_done(&sched);
+    TEST_ASSERT(ws_next(&sched, 0, &task) && task.start == 1, "owner pops the oldest task last");
+    ws_task_done(&sched);
+    TEST_ASSERT(!ws_next(&sched, 0, &task), "no tasks left");
+}
+
+static void test_steal_from_tail(void) {
+    ws_init(&sched, 2, ws_deque_capacity(2, 2), &global_std_allocator);
+
+    ws_push(&sched, 0, (ws_task_t){ .start = 1, .end = 1 });
+    ws_push(&sched, 0, (ws_task_t){ .start = 2, .end = 2 });
+
+    ws_task_t task;
+    TEST_ASSERT(ws_next(&sched, 1, &task) && task.start == 1, "thief steals the oldest task");
+    ws_task_done(&sched);
+}
+
+static void test_full_deque(void) {
+    /* Rounded up to a power of 2 */
+    ws_init(&sched, 1, 100, &global_std_allocator);
+
+    bool all_pushed = true;
+    for (size_t i = 0; i < 128; ++i) {
+        all_pushed &= ws_push(&sched, 0, (ws_task_t){ .start = i, .end = i });
+    }
+    TEST_ASSERT(all_pushed, "deque accepts its capacity of tasks");
+    TEST_ASSERT(!ws_push(&sched, 0, (ws_task_t){0}), "push fails when the deque is full");
+
+    ws_task_t task;
+    while (ws_next(&sched, 0, &task)) ws_task_done(&sched);
+}
+
+/* All the work starts in a single deque, the other threads have to steal it */
+static void test_skewed_ranges(void) {
+    thread_pool_t pool;
+    thread_pool_init(&pool, TEST_THREADS - 1);
+
+    test_worker_t workers[TEST_THREADS] = {0};
+    for (size_t i = 0; i < TEST_THREADS; ++i) {
+        workers[i].sched = &sched;
+        workers[i].thread_idx = i;
+        workers[i].grain = 64;
+    }
+
+    ws_init(&sched, TEST_THREADS, ws_deque_capacity(4, TEST_THREADS), &global_std_allocator);
+
+    /* One huge range and a few tiny ones */
+    ws_task_t ranges[] = {
+        { .start = 1,       .end = 1000000 },
+        { .start = 2000000, .end = 2000010 },
+        { .start = 3000000, .end = 3000000 },
+        { .start = 4000000, .end = 4000100 },
+    };
+
+    u64 expected_sum = 0;
+    u64 expected_items = 0;
+    for (size_t i = 0; i < sizeof (ranges) / sizeof (ranges[0]); ++i) {
+        ws_push(&sched, 0, ranges[i]);
+        for (u64 j = ranges[i].start; j <= ranges[i].end; ++j) {
+            expected_sum += j;
+            expected_items++;
+        }
+    }
+
+    thread_pool_run(&pool, sum_ranges, workers, sizeof (workers[0]), TEST_THREADS);
+
+    u64 sum = 0;
+    u64 items = 0;
+    u64 tasks = 0;
+    for (size_t i = 0; i < TEST_THREADS; ++i) {
+        sum   += workers[i].sum;
+        items += workers[i].items;
+        tasks += workers[i].tasks;
+    }
+
+    TEST_ASSERT(sum == expected_sum, "every item was processed");
+    TEST_ASSERT(items == expected_items, "no item was processed twice");
+    TEST_ASSERT(tasks >= expected_items / 64, "big ranges were split by the grain size");
+    TEST_ASSERT(atomic_load(&sched.pending) == 0, "no pending tasks after the run");
+
+    thread_pool_destroy(&pool);
+}
+
+/* More threads than tasks, the idle ones sleep on the futex until the work runs out */
+static void test_idle_threads_sleep(void) {
+    thread_pool_t pool;
+    thread_pool_init(&pool, TEST_THREADS - 1);
+
+    test_worker_t workers[TEST_THREADS] = {0};
+    for (size_t i = 0; i < TEST_THREADS; ++i) {
+        workers[i].sched = &sched;
+        workers[i].thread_idx = i;
+        /* No splits, a single task keeps one thread busy */
+        workers[i].grain = UINT64_MAX;
+    }
+
+    ws_init(&sched, TEST_THREADS, ws_deque_capacity(1, TEST_THREADS), &global_std_allocator);
+    ws_push(&sched, 0, (ws_task_t){ .start = 1, .end = 50000000 });
+
+    thread_pool_run(&pool, sum_ranges, workers, sizeof (workers[0]), TEST_THREADS);
+
+    u64 tasks = 0;
+    for (size_t i = 0; i < TEST_THREADS; ++i) tasks += workers[i].tasks;
+
+    TEST_ASSERT(tasks == 1, "the idle threads return once the only task is done");
+    TEST_ASSERT(atomic_load(&sched.sleepers) == 0, "no thread left sleeping");
+
+    thread_pool_destroy(&pool);
+}
+
+int main(void) {
+
+    printf("\n--- Start tests: Work stealing ---\n");
+    test_push_pop();
+    test_steal_from_tail();
+    test_full_deque();
+    test_skewed_ranges();
+    test_idle_threads_sleep();
+
+    printf("--- Summary: Work stealing ---\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    printf("\n");
+
+    return tests_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
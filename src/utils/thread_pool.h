@@ -0,0 +1,230 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+/*
+ * Pool of long-lived worker threads. The workers are created once and stay parked
+ * between jobs, so dispatching a job only pays the wake-up latency instead of the
+ * cost of creating and joining a thread every time.
+ *
+ * A job with task_count tasks is split between the calling thread, which always runs
+ * task 0, and workers 1..task_count-1. Only the workers that take part in the job are
+ * woken up. Each worker spins for a short while before going to sleep on a futex,
+ * so jobs dispatched back to back (e.g. benchmarks) don't even pay for the syscall.
+ */
+
+#include <assert.h>
+#include <immintrin.h>
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "futex.h"
+#include "macros.h"
+#include "typedefs.h"
+
+#ifndef THREAD_POOL_MAX_THREADS
+#define THREAD_POOL_MAX_THREADS 64
+#endif /* ifndef THREAD_POOL_MAX_THREADS */
+
+/* How many times to poll for new work before parking the thread */
+#ifndef THREAD_POOL_SPIN_COUNT
+#define THREAD_POOL_SPIN_COUNT 4096
+#endif /* ifndef THREAD_POOL_SPIN_COUNT */
+
+typedef void *(*thread_pool_task_fn)(void *arg);
+
+typedef struct thread_pool_t thread_pool_t;
+typedef struct thread_pool_worker_t thread_pool_worker_t;
+
+/* Each worker sits in its own cache line, since the dispatcher writes to it on every job */
+struct thread_pool_worker_t {
+    alignas(64)
+    /* Bumped by the dispatcher when there is a new task for this worker */
+    atomic_uint_least32_t generation;
+    /* Whether the worker is (about to be) sleeping on generation */
+    atomic_bool           parked;
+
+    /* Current task, a NULL task asks the worker to exit */
+    thread_pool_task_fn task;
+    void               *arg;
+
+    thread_pool_t *pool;
+    pthread_t      thread;
+};
+
+struct thread_pool_t {
+    thread_pool_worker_t workers[THREAD_POOL_MAX_THREADS];
+    size_t               worker_count;
+
+    alignas(64)
+    /* Tasks of the current job that were not finished by the workers */
+    atomic_uint_least32_t pending;
+    /* Whether the dispatcher is (about to be) sleeping on pending */
+    atomic_bool           dispatcher_parked;
+};
+
+/*
+ * Starts worker_count parked worker threads. A pool with worker_count workers can run
+ * jobs with up to worker_count + 1 tasks, since the calling thread also does some work.
+ *
+ * pool         - The pool to be initialized.
+ * worker_count - How many threads to spawn (may be zero).
+ *
+ * Returns:
+ *     true if all the threads were created successfully. Otherwise the threads already
+ *     created are stopped and joined, and the pool has no workers.
+ */
+internal bool thread_pool_init(thread_pool_t *pool, size_t worker_count);
+
+/*
+ * Runs task(args + i * arg_stride) for i in [0, task_count) and waits until all of them
+ * finish. Task 0 runs on the calling thread. Only one job can run at a time.
+ *
+ * pool       - The pool where the tasks will run.
+ * task       - Function to be called for each task.
+ * args       - Base address of the argument array.
+ * arg_stride - Size in bytes of each element of args.
+ * task_count - Number of tasks, at most worker_count + 1.
+ */
+internal void thread_pool_run(thread_pool_t *pool, thread_pool_task_fn task,
+        void *args, size_t arg_stride, size_t task_count);
+
+/* Asks every worker to exit and joins them */
+internal void thread_pool_destroy(thread_pool_t *pool);
+
+internal inline void thread_pool_wake_worker(thread_pool_worker_t *worker) {
+
+    atomic_fetch_add_explicit(&worker->generation, 1, memory_order_seq_cst);
+
+    if (atomic_load_explicit(&worker->parked, memory_order_seq_cst)) {
+        futex_wake(&worker->generation, 1);
+    }
+}
+
+internal void *thread_pool_worker_loop(void *arg) {
+
+    thread_pool_worker_t *worker = arg;
+    thread_pool_t *pool = worker->pool;
+
+    u32 seen = 0;
+
+    for (;;) {
+
+        u32 generation = atomic_load_explicit(&worker->generation, memory_order_acquire);
+
+        for (u32 spin = 0; generation == seen && spin < THREAD_POOL_SPIN_COUNT; ++spin) {
+            _mm_pause();
+            generation = atomic_load_explicit(&worker->generation, memory_order_acquire);
+        }
+
+        while (generation == seen) {
+            atomic_store_explicit(&worker->parked, true, memory_order_seq_cst);
+
+            /* Recheck after announcing that we are going to sleep, otherwise we could miss a wake up */
+            generation = atomic_load_explicit(&worker->generation, memory_order_seq_cst);
+            if (generation == seen) {
+                futex_wait(&worker->generation, seen);
+                generation = atomic_load_explicit(&worker->generation, memory_order_acquire);
+            }
+
+            atomic_store_explicit(&worker->parked, false, memory_order_relaxed);
+        }
+
+        seen = generation;
+
+        if (worker->task == NULL) break;
+
+        worker->task(worker->arg);
+
+        if (atomic_fetch_sub_explicit(&pool->pending, 1, memory_order_acq_rel) == 1
+                && atomic_load_explicit(&pool->dispatcher_parked, memory_order_seq_cst)) {
+            futex_wake(&pool->pending, 1);
+        }
+    }
+
+    return NULL;
+}
+
+internal bool thread_pool_init(thread_pool_t *pool, size_t worker_count) {
+
+    assert(worker_count <= THREAD_POOL_MAX_THREADS && "Too many workers for the thread pool");
+
+    pool->worker_count = 0;
+    atomic_init(&pool->pending, 0);
+    atomic_init(&pool->dispatcher_parked, false);
+
+    for (size_t i = 0; i < worker_count; ++i) {
+        thread_pool_worker_t *worker = &pool->workers[i];
+
+        atomic_init(&worker->generation, 0);
+        atomic_init(&worker->parked, false);
+        worker->task = NULL;
+        worker->arg  = NULL;
+        worker->pool = pool;
+
+        if (pthread_create(&worker->thread, NULL, thread_pool_worker_loop, worker) != 0) {
+            thread_pool_destroy(pool);
+            return false;
+        }
+
+        ++pool->worker_count;
+    }
+
+    return true;
+}
+
+internal void thread_pool_run(thread_pool_t *pool, thread_pool_task_fn task,
+        void *args, size_t arg_stride, size_t task_count) {
+
+    assert(task_count > 0 && task_count <= pool->worker_count + 1 && "Not enough workers for this job");
+
+    atomic_store_explicit(&pool->pending, task_count - 1, memory_order_relaxed);
+
+    for (size_t i = 1; i < task_count; ++i) {
+        thread_pool_worker_t *worker = &pool->workers[i - 1];
+
+        worker->task = task;
+        worker->arg  = (u8 *)args + i * arg_stride;
+
+        thread_pool_wake_worker(worker);
+    }
+
+    task(args);
+
+    u32 pending = atomic_load_explicit(&pool->pending, memory_order_acquire);
+
+    for (u32 spin = 0; pending != 0 && spin < THREAD_POOL_SPIN_COUNT; ++spin) {
+        _mm_pause();
+        pending = atomic_load_explicit(&pool->pending, memory_order_acquire);
+    }
+
+    while (pending != 0) {
+        atomic_store_explicit(&pool->dispatcher_parked, true, memory_order_seq_cst);
+
+        pending = atomic_load_explicit(&pool->pending, memory_order_seq_cst);
+        if (pending != 0) {
+            futex_wait(&pool->pending, pending);
+            pending = atomic_load_explicit(&pool->pending, memory_order_acquire);
+        }
+
+        atomic_store_explicit(&pool->dispatcher_parked, false, memory_order_relaxed);
+    }
+}
+
+internal void thread_pool_destroy(thread_pool_t *pool) {
+
+    for (size_t i = 0; i < pool->worker_count; ++i) {
+        pool->workers[i].task = NULL;
+        thread_pool_wake_worker(&pool->workers[i]);
+    }
+
+    for (size_t i = 0; i < pool->worker_count; ++i) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+
+    pool->worker_count = 0;
+}
+
+#endif /* ifndef THREAD_POOL_H */
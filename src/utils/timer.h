@@ -0,0 +1,195 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+/*
+ * Timestamps from the time stamp counter (TSC), for phases too short for clock_gettime.
+ *
+ * clock_gettime(CLOCK_MONOTONIC) costs 20+ ns per call through the vDSO, which is as
+ * long as the phases some parts want to time. Reading the TSC takes a few ns, so when
+ * the CPU has an invariant TSC (same rate in every P-state and C-state, in sync between
+ * the cores) the timestamps are read from it, and converted to ns with a rate calibrated
+ * against CLOCK_MONOTONIC the first time the timer is used. Without an invariant TSC, or
+ * with AOC_TIMER=clock, it falls back to clock_gettime.
+ *
+ * Short intervals are measured in ticks and converted at the end:
+ *
+ *     u64 start = timer_ticks();
+ *     ...
+ *     u64 elapsed_ns = timer_ticks_to_ns(timer_ticks_end() - start);
+ *
+ * The reads are fenced with lfence, so the measured code can not move across them
+ * (Linux makes lfence dispatch serializing on AMD as well).
+ */
+
+#include <cpuid.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <x86intrin.h>
+
+#include "macros.h"
+#include "typedefs.h"
+
+/* The profiler (gf_profiling.c) reads the timer from the -finstrument-functions hooks */
+#define TIMER_NO_INSTRUMENT __attribute__((no_instrument_function))
+
+/* How long the TSC is compared against CLOCK_MONOTONIC, the error is ~50 ns over it */
+#ifndef TIMER_CALIBRATION_NS
+#define TIMER_CALIBRATION_NS (200 * 1000)
+#endif /* ifndef TIMER_CALIBRATION_NS */
+
+enum timer_source {
+    TIMER_CLOCK = 0,
+    TIMER_TSC,
+};
+
+typedef struct {
+    enum timer_source source;
+    bool              has_rdtscp;
+    /* Ticks per second (1e9 with the clock, the ticks are ns) */
+    u64               frequency;
+    /* ns = ticks * mult >> 32 */
+    u64               mult;
+    /* Set by the thread that calibrates, the others wait for initialized */
+    bool              calibrating;
+    /* Set last, once the rest can be read */
+    bool              initialized;
+} timer_state_t;
+
+/*
+ * Shared by every translation unit that includes this header (weak, so the definitions
+ * merge at link time): a program linking several days calibrates once, not on the
+ * first timed run of each day.
+ */
+__attribute__((weak)) timer_state_t timer_state;
+
+/*
+ * Picks the source and calibrates the TSC (TIMER_CALIBRATION_NS of busy waiting). Called
+ * by the first read, so programs that time nothing never pay for it. When several
+ * threads get there at once, one calibrates and the others wait for it.
+ */
+TIMER_NO_INSTRUMENT internal void timer_init(void);
+
+TIMER_NO_INSTRUMENT internal inline u64 timer_clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Current tick, to start an interval */
+TIMER_NO_INSTRUMENT internal force_inline u64 timer_ticks(void) {
+    if (unlikely(!__atomic_load_n(&timer_state.initialized, __ATOMIC_ACQUIRE))) timer_init();
+    if (timer_state.source != TIMER_TSC) return timer_clock_ns();
+
+    _mm_lfence();
+    u64 ticks = __rdtsc();
+    _mm_lfence();
+    return ticks;
+}
+
+/* Current tick, to end an interval: rdtscp waits for the measured code to finish */
+TIMER_NO_INSTRUMENT internal force_inline u64 timer_ticks_end(void) {
+    if (unlikely(!__atomic_load_n(&timer_state.initialized, __ATOMIC_ACQUIRE))) timer_init();
+    if (timer_state.source != TIMER_TSC) return timer_clock_ns();
+
+    u64 ticks;
+    if (timer_state.has_rdtscp) {
+        u32 aux;
+        ticks = __rdtscp(&aux);
+    } else {
+        _mm_lfence();
+        ticks = __rdtsc();
+    }
+    _mm_lfence();
+    return ticks;
+}
+
+TIMER_NO_INSTRUMENT internal inline const char *timer_source_name(void) {
+    return timer_state.source == TIMER_TSC ? "tsc" : "clock_gettime";
+}
+
+/* Length of an interval of ticks in ns */
+TIMER_NO_INSTRUMENT internal force_inline u64 timer_ticks_to_ns(u64 ticks) {
+    if (timer_state.source != TIMER_TSC) return ticks;
+    return (u64)(((unsigned __int128)ticks * timer_state.mult) >> 32);
+}
+
+/* Monotonic timestamp in ns, with an arbitrary origin */
+TIMER_NO_INSTRUMENT internal force_inline u64 timer_now_ns(void) {
+    return timer_ticks_to_ns(timer_ticks());
+}
+
+/* CPUID 0x80000007: EDX bit 8 is the invariant TSC */
+TIMER_NO_INSTRUMENT internal bool timer_tsc_invariant(void) {
+
+    u32 eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007) return false;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) return false;
+
+    return edx & (1u << 8);
+}
+
+/*
+ * A clock read and the TSC at the same instant: the clock read sits between two TSC reads
+ * and happened around their midpoint. The first read of the vDSO is slow (page faults) and
+ * the VM can be descheduled, so the narrowest of a few tries is kept.
+ */
+TIMER_NO_INSTRUMENT internal void timer_calibration_sample(u64 *ns, u64 *tick) {
+
+    u64 narrowest = UINT64_MAX;
+    for (int i = 0; i < 8; ++i) {
+        u64 before = __rdtsc();
+        u64 now    = timer_clock_ns();
+        u64 after  = __rdtsc();
+
+        if (after - before < narrowest) {
+            narrowest = after - before;
+            *ns       = now;
+            *tick     = before + (after - before) / 2;
+        }
+    }
+}
+
+TIMER_NO_INSTRUMENT internal void timer_init(void) {
+
+    if (__atomic_load_n(&timer_state.initialized, __ATOMIC_ACQUIRE)) return;
+
+    if (__atomic_exchange_n(&timer_state.calibrating, true, __ATOMIC_ACQ_REL)) {
+        while (!__atomic_load_n(&timer_state.initialized, __ATOMIC_ACQUIRE)) _mm_pause();
+        return;
+    }
+
+    timer_state.source    = TIMER_CLOCK;
+    timer_state.frequency = 1000000000ULL;
+    timer_state.mult      = 1ULL << 32;
+
+    u32 eax, ebx, ecx, edx;
+    timer_state.has_rdtscp = __get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx) && (edx & (1u << 27));
+
+    const char *forced = getenv("AOC_TIMER");
+    bool use_tsc = !(forced && strcmp(forced, "clock") == 0) && timer_tsc_invariant();
+
+    if (use_tsc) {
+        u64 start_ns = 0, start_tick = 0;
+        timer_calibration_sample(&start_ns, &start_tick);
+
+        u64 end_ns = 0, end_tick = 0;
+        do {
+            timer_calibration_sample(&end_ns, &end_tick);
+        } while (end_ns - start_ns < TIMER_CALIBRATION_NS);
+
+        u64 ticks = end_tick - start_tick;
+        u64 ns    = end_ns - start_ns;
+
+        if (ticks > 0) {
+            timer_state.source    = TIMER_TSC;
+            timer_state.mult      = (u64)(((unsigned __int128)ns << 32) / ticks);
+            timer_state.frequency = (u64)((unsigned __int128)ticks * 1000000000ULL / ns);
+        }
+    }
+
+    __atomic_store_n(&timer_state.initialized, true, __ATOMIC_RELEASE);
+}
+
+#endif /* ifndef TIMER_H */
@@ -0,0 +1,339 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+/*
+ * CPU topology (from sysfs) and thread pinning policies.
+ *
+ * The topology is reduced to what matters for the solutions: which logical CPUs are
+ * SMT siblings of the same physical core and which ones share the last level cache.
+ * On Zen processors each L3 domain is a CCD, so keeping threads inside one L3 domain
+ * keeps the barriers and shared data from bouncing between CCDs.
+ *
+ * pthread_setaffinity_np requires _GNU_SOURCE to be defined before any system header.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "macros.h"
+#include "typedefs.h"
+#include "parsing_helpers.h"
+#include "thread_pool.h"
+
+#ifndef TOPOLOGY_MAX_CPUS
+#define TOPOLOGY_MAX_CPUS 256
+#endif /* ifndef TOPOLOGY_MAX_CPUS */
+
+#define TOPOLOGY_SYSFS_CPU "/sys/devices/system/cpu/"
+
+enum pin_policy {
+    /* Let the scheduler place the threads */
+    PIN_NONE = 0,
+    /* One thread per physical core, SMT siblings are only used after every core is taken */
+    PIN_PHYSICAL_FIRST,
+    /* Fill one L3 domain (CCD) before moving to the next one */
+    PIN_SAME_CCD,
+    /* Round robin between L3 domains, physical cores first */
+    PIN_SPREAD,
+    PIN_POLICY_COUNT
+};
+
+global_var const char *pin_policy_names[PIN_POLICY_COUNT] = {
+    [PIN_NONE]           = "none",
+    [PIN_PHYSICAL_FIRST] = "physical-first",
+    [PIN_SAME_CCD]       = "same-ccd",
+    [PIN_SPREAD]         = "spread",
+};
+
+typedef struct {
+    u16 cpu;
+    /* Position of the CPU among its SMT siblings (0 for the first hardware thread) */
+    u16 smt_rank;
+    /* Dense index of the L3 domain the CPU belongs to */
+    u16 l3_domain;
+    /* Position of the CPU among the CPUs with the same smt_rank in its L3 domain */
+    u16 domain_rank;
+} cpu_info_t;
+
+typedef struct {
+    cpu_info_t cpus[TOPOLOGY_MAX_CPUS];
+    size_t     cpu_count;
+    size_t     l3_domain_count;
+} cpu_topology_t;
+
+/*
+ * Reads the topology of the online CPUs from sysfs.
+ *
+ * Returns:
+ *     false if the topology could not be read.
+ */
+internal bool topology_read(cpu_topology_t *topo);
+
+/*
+ * Fills smt_rank/l3_domain/domain_rank from the raw sibling information. Exposed
+ * separately so tests can build fake topologies.
+ *
+ * first_sibling - For each CPU, the first CPU in its thread_siblings_list.
+ * first_l3_cpu  - For each CPU, the first CPU in the shared_cpu_list of its L3.
+ */
+internal void topology_build(cpu_topology_t *topo, const u16 *first_sibling, const u16 *first_l3_cpu);
+
+/*
+ * Orders the CPUs according to the policy. Thread i should be pinned to order[i % count].
+ *
+ * Returns:
+ *     How many CPUs were written to order (0 for PIN_NONE).
+ */
+internal size_t topology_order(const cpu_topology_t *topo, enum pin_policy policy, u16 *order);
+
+/* Pins a thread to a single logical CPU, returns false on failure */
+internal bool topology_pin_thread(pthread_t thread, u16 cpu);
+
+/* Parses a policy name (see pin_policy_names), returns PIN_POLICY_COUNT if unknown */
+internal enum pin_policy pin_policy_from_cstr(const char *name);
+
+/* Policy from the AOC_PIN_POLICY environment variable, or default_policy if not set (or invalid) */
+internal enum pin_policy pin_policy_from_env(enum pin_policy default_policy);
+
+/*
+ * Pins the threads of the pool according to the policy. The calling thread, which runs
+ * task 0 of every job, is pinned to the first CPU in the order and worker i to the CPU
+ * i + 1, so part context i always runs on the same CPU.
+ *
+ * If pinning one of the threads fails, the threads pinned before it get back the affinity
+ * the calling thread had, so none of them stays pinned.
+ *
+ * Returns:
+ *     The policy that was applied, PIN_NONE if the topology is not available or pinning failed.
+ */
+internal enum pin_policy topology_pin_pool(thread_pool_t *pool, enum pin_policy policy);
+
+/* Parses a sysfs CPU list such as "0-3,8,10-11". Returns how many CPUs were read. */
+internal size_t topology_parse_cpu_list(string_t list, u16 *cpus, size_t max_cpus) {
+
+    size_t count = 0;
+
+    while (list.count > 0 && '0' <= list.chars[0] && list.chars[0] <= '9') {
+        u64 first = parse_u64(list, &list);
+        u64 last  = first;
+
+        if (list.count > 0 && list.chars[0] == '-') {
+            skip_char(list, &list, '-');
+            last = parse_u64(list, &list);
+        }
+
+        for (u64 cpu = first; cpu <= last && count < max_cpus; ++cpu) {
+            cpus[count++] = (u16)cpu;
+        }
+
+        skip_char(list, &list, ',');
+    }
+
+    return count;
+}
+
+internal size_t topology_read_cpu_list(const char *path, u16 *cpus, size_t max_cpus) {
+
+    FILE *file = fopen(path, "r");
+    if (!file) return 0;
+
+    char line[4096];
+    size_t count = 0;
+
+    if (fgets(line, sizeof (line), file)) {
+        count = topology_parse_cpu_list(string_from_cstr(line), cpus, max_cpus);
+    }
+
+    fclose(file);
+    return count;
+}
+
+internal bool topology_read(cpu_topology_t *topo) {
+
+    u16 online[TOPOLOGY_MAX_CPUS];
+    size_t online_count = topology_read_cpu_list(TOPOLOGY_SYSFS_CPU"online", online, TOPOLOGY_MAX_CPUS);
+
+    if (online_count == 0) return false;
+
+    /* Only consider the CPUs this process is allowed to run on (e.g. inside a cpuset) */
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof (allowed), &allowed) == 0) {
+        size_t allowed_count = 0;
+        for (size_t i = 0; i < online_count; ++i) {
+            if (CPU_ISSET(online[i], &allowed)) online[allowed_count++] = online[i];
+        }
+        online_count = allowed_count;
+    }
+
+    if (online_count == 0) return false;
+
+    u16 first_sibling[TOPOLOGY_MAX_CPUS];
+    u16 first_l3_cpu[TOPOLOGY_MAX_CPUS];
+
+    for (size_t i = 0; i < online_count; ++i) {
+        char path[256];
+        u16 list[TOPOLOGY_MAX_CPUS];
+
+        topo->cpus[i].cpu = online[i];
+
+        snprintf(path, sizeof (path), TOPOLOGY_SYSFS_CPU"cpu%u/topology/thread_siblings_list", online[i]);
+        first_sibling[i] = topology_read_cpu_list(path, list, TOPOLOGY_MAX_CPUS) ? list[0] : online[i];
+
+        /* Without an L3 every CPU is in the same domain */
+        snprintf(path, sizeof (path), TOPOLOGY_SYSFS_CPU"cpu%u/cache/index3/shared_cpu_list", online[i]);
+        first_l3_cpu[i] = topology_read_cpu_list(path, list, TOPOLOGY_MAX_CPUS) ? list[0] : 0;
+    }
+
+    topo->cpu_count = online_count;
+    topology_build(topo, first_sibling, first_l3_cpu);
+
+    return true;
+}
+
+internal void topology_build(cpu_topology_t *topo, const u16 *first_sibling, const u16 *first_l3_cpu) {
+
+    u16 domain_keys[TOPOLOGY_MAX_CPUS];
+    topo->l3_domain_count = 0;
+
+    for (size_t i = 0; i < topo->cpu_count; ++i) {
+        cpu_info_t *info = &topo->cpus[i];
+
+        /* SMT rank: how many siblings come before this CPU */
+        info->smt_rank = 0;
+        for (size_t j = 0; j < i; ++j) {
+            if (first_sibling[j] == first_sibling[i]) ++info->smt_rank;
+        }
+
+        /* L3 domains are numbered in order of appearance */
+        size_t domain = 0;
+        while (domain < topo->l3_domain_count && domain_keys[domain] != first_l3_cpu[i]) ++domain;
+        if (domain == topo->l3_domain_count) {
+            domain_keys[topo->l3_domain_count++] = first_l3_cpu[i];
+        }
+        info->l3_domain = (u16)domain;
+
+        info->domain_rank = 0;
+        for (size_t j = 0; j < i; ++j) {
+            if (topo->cpus[j].l3_domain == info->l3_domain && topo->cpus[j].smt_rank == info->smt_rank) {
+                ++info->domain_rank;
+            }
+        }
+    }
+}
+
+/* Whether a should come before b for the given policy */
+internal inline bool topology_cpu_before(const cpu_info_t *a, const cpu_info_t *b, enum pin_policy policy) {
+
+    switch (policy) {
+    case PIN_PHYSICAL_FIRST:
+        if (a->smt_rank != b->smt_rank) return a->smt_rank < b->smt_rank;
+        return a->cpu < b->cpu;
+    case PIN_SAME_CCD:
+        if (a->l3_domain != b->l3_domain) return a->l3_domain < b->l3_domain;
+        if (a->smt_rank != b->smt_rank) return a->smt_rank < b->smt_rank;
+        return a->cpu < b->cpu;
+    case PIN_SPREAD:
+        if (a->smt_rank != b->smt_rank) return a->smt_rank < b->smt_rank;
+        if (a->domain_rank != b->domain_rank) return a->domain_rank < b->domain_rank;
+        return a->l3_domain < b->l3_domain;
+    case PIN_NONE:
+    case PIN_POLICY_COUNT:
+    default:
+        return a->cpu < b->cpu;
+    }
+}
+
+internal size_t topology_order(const cpu_topology_t *topo, enum pin_policy policy, u16 *order) {
+
+    if (policy == PIN_NONE || policy >= PIN_POLICY_COUNT) return 0;
+
+    cpu_info_t sorted[TOPOLOGY_MAX_CPUS];
+    memcpy(sorted, topo->cpus, topo->cpu_count * sizeof (sorted[0]));
+
+    /* Insertion sort, there are only a few hundred CPUs at most */
+    for (size_t i = 1; i < topo->cpu_count; ++i) {
+        cpu_info_t current = sorted[i];
+        size_t j = i;
+        while (j > 0 && topology_cpu_before(&current, &sorted[j - 1], policy)) {
+            sorted[j] = sorted[j - 1];
+            --j;
+        }
+        sorted[j] = current;
+    }
+
+    for (size_t i = 0; i < topo->cpu_count; ++i) {
+        order[i] = sorted[i].cpu;
+    }
+
+    return topo->cpu_count;
+}
+
+internal bool topology_pin_thread(pthread_t thread, u16 cpu) {
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+
+    return pthread_setaffinity_np(thread, sizeof (set), &set) == 0;
+}
+
+internal enum pin_policy pin_policy_from_cstr(const char *name) {
+
+    for (enum pin_policy policy = 0; policy < PIN_POLICY_COUNT; ++policy) {
+        if (strcmp(name, pin_policy_names[policy]) == 0) return policy;
+    }
+
+    return PIN_POLICY_COUNT;
+}
+
+internal enum pin_policy pin_policy_from_env(enum pin_policy default_policy) {
+
+    const char *name = getenv("AOC_PIN_POLICY");
+    if (name == NULL) return default_policy;
+
+    enum pin_policy policy = pin_policy_from_cstr(name);
+    if (policy == PIN_POLICY_COUNT) {
+        fprintf(stderr, "Unknown pin policy '%s', using '%s'\n", name, pin_policy_names[default_policy]);
+        return default_policy;
+    }
+
+    return policy;
+}
+
+internal enum pin_policy topology_pin_pool(thread_pool_t *pool, enum pin_policy policy) {
+
+    if (policy == PIN_NONE || policy >= PIN_POLICY_COUNT) return PIN_NONE;
+
+    cpu_topology_t topo;
+    if (!topology_read(&topo)) return PIN_NONE;
+
+    u16 order[TOPOLOGY_MAX_CPUS];
+    size_t cpu_count = topology_order(&topo, policy, order);
+    if (cpu_count == 0) return PIN_NONE;
+
+    /* The workers were started by this thread, so they have the same affinity */
+    cpu_set_t original;
+    if (pthread_getaffinity_np(pthread_self(), sizeof (original), &original) != 0) return PIN_NONE;
+
+    if (!topology_pin_thread(pthread_self(), order[0])) return PIN_NONE;
+
+    for (size_t i = 0; i < pool->worker_count; ++i) {
+        if (topology_pin_thread(pool->workers[i].thread, order[(i + 1) % cpu_count])) continue;
+
+        /* Undo the threads pinned so far, so the policy really is none */
+        pthread_setaffinity_np(pthread_self(), sizeof (original), &original);
+        for (size_t j = 0; j < i; ++j) {
+            pthread_setaffinity_np(pool->workers[j].thread, sizeof (original), &original);
+        }
+        return PIN_NONE;
+    }
+
+    return policy;
+}
+
+#endif /* ifndef TOPOLOGY_H */
@@ -0,0 +1,132 @@
+#ifndef UNIX_SOCKET_H
+#define UNIX_SOCKET_H
+
+/*
+ * Local (Unix domain) stream sockets with length-prefixed messages.
+ *
+ * A message is its size as a u64 (native byte order, both ends are on the same
+ * machine) followed by that many bytes. Messages are read in two steps, so the
+ * receiver can decide where to put the payload once it knows its size:
+ *
+ *     u64 size;
+ *     if (unix_socket_recv_size(fd, &size)) {
+ *         char *payload = allocator_alloc(allocator, size);
+ *         unix_socket_recv_all(fd, payload, size);
+ *     }
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "typedefs.h"
+
+/*
+ * Creates a socket listening at path, replacing a stale socket file left there.
+ *
+ * Returns:
+ *     The listening socket, or -1 on error.
+ */
+internal int unix_socket_listen(const char *path);
+
+/* Connects to the socket at path, returns -1 on error */
+internal int unix_socket_connect(const char *path);
+
+/* Sends or receives exactly size bytes, returns false if the connection failed or was closed */
+internal bool unix_socket_send_all(int fd, const void *data, size_t size);
+internal bool unix_socket_recv_all(int fd, void *data, size_t size);
+
+/* Sends a whole message (size, then payload) */
+internal bool unix_socket_send_message(int fd, const void *data, u64 size);
+
+/* Receives the size of the next message, its payload has to be read with unix_socket_recv_all */
+internal bool unix_socket_recv_size(int fd, u64 *size);
+
+internal bool unix_socket_address(const char *path, struct sockaddr_un *address) {
+
+    memset(address, 0, sizeof (*address));
+    address->sun_family = AF_UNIX;
+
+    if (strlen(path) >= sizeof (address->sun_path)) return false;
+    strcpy(address->sun_path, path);
+
+    return true;
+}
+
+internal int unix_socket_listen(const char *path) {
+
+    struct sockaddr_un address;
+    if (!unix_socket_address(path, &address)) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    unlink(path);
+
+    if (bind(fd, (struct sockaddr *)&address, sizeof (address)) != 0 || listen(fd, 16) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+internal int unix_socket_connect(const char *path) {
+
+    struct sockaddr_un address;
+    if (!unix_socket_address(path, &address)) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    if (connect(fd, (struct sockaddr *)&address, sizeof (address)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+internal bool unix_socket_send_all(int fd, const void *data, size_t size) {
+
+    const char *bytes = data;
+
+    while (size > 0) {
+        /* MSG_NOSIGNAL: a peer that went away is an error, not a SIGPIPE */
+        ssize_t sent = send(fd, bytes, size, MSG_NOSIGNAL);
+        if (sent <= 0) return false;
+
+        bytes += sent;
+        size  -= sent;
+    }
+
+    return true;
+}
+
+internal bool unix_socket_recv_all(int fd, void *data, size_t size) {
+
+    char *bytes = data;
+
+    while (size > 0) {
+        ssize_t received = recv(fd, bytes, size, 0);
+        if (received <= 0) return false;
+
+        bytes += received;
+        size  -= received;
+    }
+
+    return true;
+}
+
+internal bool unix_socket_send_message(int fd, const void *data, u64 size) {
+    return unix_socket_send_all(fd, &size, sizeof (size)) && unix_socket_send_all(fd, data, size);
+}
+
+internal bool unix_socket_recv_size(int fd, u64 *size) {
+    return unix_socket_recv_all(fd, size, sizeof (*size));
+}
+
+#endif /* ifndef UNIX_SOCKET_H */
@@ -0,0 +1,297 @@
+#ifndef WORK_STEALING_H
+#define WORK_STEALING_H
+
+/*
+ * Work-stealing scheduler for range tasks with irregular costs.
+ *
+ * Every thread owns a deque of tasks. The owner pushes and pops tasks at the head
+ * (newest first, which keeps its working set warm), while idle threads steal from
+ * the tail of other deques, taking the oldest (and usually biggest) tasks.
+ *
+ * Big ranges don't need to be split up front: ws_split keeps the lower part of a
+ * task and pushes the upper halves back to the owner deque, so they are available
+ * to thieves while the owner is busy.
+ *
+ * Usage inside a part (every thread):
+ *
+ *     ws_task_t task;
+ *     while (ws_next(&sched, thread_idx, &task)) {
+ *         ws_split(&sched, thread_idx, &task, GRAIN);
+ *         ... process [task.start, task.end] ...
+ *         ws_task_done(&sched);
+ *     }
+ *
+ * Each deque is protected by a small spinlock, tasks are expected to be much more
+ * expensive than taking it. The deques are sized at ws_init (see ws_deque_capacity).
+ *
+ * Idle threads spin for a short while looking for tasks, then sleep on a futex that
+ * ws_push and the last ws_task_done wake, so they don't take the CPU from the threads
+ * still working when there are more threads than cores.
+ */
+
+#include <assert.h>
+#include <immintrin.h>
+#include <limits.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "allocator.h"
+#include "futex.h"
+#include "macros.h"
+#include "typedefs.h"
+
+#ifndef WS_MAX_THREADS
+#define WS_MAX_THREADS 32
+#endif /* ifndef WS_MAX_THREADS */
+
+/* Room left in every deque for the halves pushed by ws_split (see ws_deque_capacity) */
+#ifndef WS_SPLIT_SLOTS
+#define WS_SPLIT_SLOTS 64
+#endif /* ifndef WS_SPLIT_SLOTS */
+
+/* How many times an idle thread looks for tasks before sleeping on the futex */
+#ifndef WS_SPIN_COUNT
+#define WS_SPIN_COUNT 64
+#endif /* ifndef WS_SPIN_COUNT */
+
+/* An inclusive range of work items, [start, end] */
+typedef struct {
+    u64 start;
+    u64 end;
+} ws_task_t;
+
+typedef struct {
+    alignas(64)
+    atomic_flag lock;
+    /* The owner pushes and pops here */
+    size_t head;
+    /* Thieves steal from here */
+    size_t tail;
+    /* Capacity - 1, the capacity is a power of 2 */
+    size_t mask;
+    ws_task_t *tasks;
+} ws_deque_t;
+
+typedef struct {
+    ws_deque_t deques[WS_MAX_THREADS];
+    size_t     thread_count;
+
+    alignas(64)
+    /* Tasks that were pushed but not finished yet */
+    atomic_size_t pending;
+
+    alignas(64)
+    /* Bumped when there may be something new for the idle threads (a task or the end) */
+    atomic_uint_least32_t signal;
+    /* Threads sleeping (or about to sleep) on signal */
+    atomic_uint_least32_t sleepers;
+} ws_scheduler_t;
+
+/*
+ * Capacity of each deque for task_count tasks dealt round robin to thread_count threads,
+ * with room for the halves pushed by ws_split.
+ */
+internal size_t ws_deque_capacity(size_t task_count, size_t thread_count);
+
+/*
+ * Prepares the scheduler for thread_count threads with empty deques of (at least)
+ * deque_capacity tasks each, allocated from allocator.
+ *
+ * Returns:
+ *     false if the deques could not be allocated.
+ */
+internal bool ws_init(ws_scheduler_t *sched, size_t thread_count, size_t deque_capacity, const allocator_t *allocator);
+
+/*
+ * Pushes a task to the head of the deque owned by thread_idx. Any thread may push
+ * into any deque, which allows one thread to distribute the initial tasks.
+ *
+ * Returns:
+ *     false if the deque is full (the task was not pushed).
+ */
+internal bool ws_push(ws_scheduler_t *sched, size_t thread_idx, ws_task_t task);
+
+/*
+ * Gets the next task for thread_idx: first from its own deque, then stealing from the
+ * others. Waits while other threads still have tasks in flight, since they might push
+ * more work.
+ *
+ * Returns:
+ *     false when every pushed task was finished.
+ */
+internal bool ws_next(ws_scheduler_t *sched, size_t thread_idx, ws_task_t *task);
+
+/* Marks a task obtained by ws_next as finished */
+internal void ws_task_done(ws_scheduler_t *sched);
+
+/*
+ * Halves the task until it has at most grain items, pushing the upper halves to the
+ * deque of thread_idx so other threads can steal them.
+ */
+internal void ws_split(ws_scheduler_t *sched, size_t thread_idx, ws_task_t *task, u64 grain);
+
+internal inline void ws_deque_lock(ws_deque_t *deque) {
+    while (atomic_flag_test_and_set_explicit(&deque->lock, memory_order_acquire)) {
+        _mm_pause();
+    }
+}
+
+internal inline void ws_deque_unlock(ws_deque_t *deque) {
+    atomic_flag_clear_explicit(&deque->lock, memory_order_release);
+}
+
+internal size_t ws_deque_capacity(size_t task_count, size_t thread_count) {
+    return (task_count + thread_count - 1) / thread_count + WS_SPLIT_SLOTS;
+}
+
+internal bool ws_init(ws_scheduler_t *sched, size_t thread_count, size_t deque_capacity, const allocator_t *allocator) {
+
+    assert(thread_count > 0 && thread_count <= WS_MAX_THREADS && "Invalid thread count for the scheduler");
+
+    size_t capacity = 1;
+    while (capacity < deque_capacity) capacity <<= 1;
+
+    ws_task_t *tasks = allocator_alloc(allocator, thread_count * capacity * sizeof (ws_task_t));
+    if (!tasks) return false;
+
+    sched->thread_count = thread_count;
+    atomic_init(&sched->pending, 0);
+    atomic_init(&sched->signal, 0);
+    atomic_init(&sched->sleepers, 0);
+
+    for (size_t i = 0; i < thread_count; ++i) {
+        atomic_flag_clear(&sched->deques[i].lock);
+        sched->deques[i].head  = 0;
+        sched->deques[i].tail  = 0;
+        sched->deques[i].mask  = capacity - 1;
+        sched->deques[i].tasks = tasks + i * capacity;
+    }
+
+    return true;
+}
+
+/* Wakes waiter_count idle threads, if any is sleeping */
+internal inline void ws_wake(ws_scheduler_t *sched, u32 waiter_count) {
+
+    /* Orders what was published before against the load of sleepers (see ws_next) */
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if (atomic_load_explicit(&sched->sleepers, memory_order_relaxed) > 0) {
+        atomic_fetch_add_explicit(&sched->signal, 1, memory_order_seq_cst);
+        futex_wake(&sched->signal, waiter_count);
+    }
+}
+
+internal bool ws_push(ws_scheduler_t *sched, size_t thread_idx, ws_task_t task) {
+
+    ws_deque_t *deque = &sched->deques[thread_idx];
+    bool pushed = false;
+
+    ws_deque_lock(deque);
+
+    if (deque->head - deque->tail <= deque->mask) {
+        /* Count it before it becomes visible, so nobody sees an empty scheduler */
+        atomic_fetch_add_explicit(&sched->pending, 1, memory_order_relaxed);
+        deque->tasks[deque->head++ & deque->mask] = task;
+        pushed = true;
+    }
+
+    ws_deque_unlock(deque);
+
+    if (pushed) ws_wake(sched, 1);
+
+    return pushed;
+}
+
+internal inline bool ws_pop(ws_deque_t *deque, ws_task_t *task) {
+
+    bool popped = false;
+
+    ws_deque_lock(deque);
+
+    if (deque->head != deque->tail) {
+        *task = deque->tasks[--deque->head & deque->mask];
+        popped = true;
+    }
+
+    ws_deque_unlock(deque);
+
+    return popped;
+}
+
+internal inline bool ws_steal(ws_deque_t *deque, ws_task_t *task) {
+
+    bool stolen = false;
+
+    ws_deque_lock(deque);
+
+    if (deque->head != deque->tail) {
+        *task = deque->tasks[deque->tail++ & deque->mask];
+        stolen = true;
+    }
+
+    ws_deque_unlock(deque);
+
+    return stolen;
+}
+
+/* Own deque first, then steals from the others */
+internal inline bool ws_find(ws_scheduler_t *sched, size_t thread_idx, ws_task_t *task) {
+
+    if (ws_pop(&sched->deques[thread_idx], task)) return true;
+
+    for (size_t i = 1; i < sched->thread_count; ++i) {
+        size_t victim = (thread_idx + i) % sched->thread_count;
+        if (ws_steal(&sched->deques[victim], task)) return true;
+    }
+
+    return false;
+}
+
+internal bool ws_next(ws_scheduler_t *sched, size_t thread_idx, ws_task_t *task) {
+
+    for (;;) {
+        for (u32 spin = 0; spin < WS_SPIN_COUNT; ++spin) {
+            if (ws_find(sched, thread_idx, task)) return true;
+            if (atomic_load_explicit(&sched->pending, memory_order_acquire) == 0) return false;
+            _mm_pause();
+        }
+
+        u32 signal = atomic_load_explicit(&sched->signal, memory_order_seq_cst);
+        atomic_fetch_add_explicit(&sched->sleepers, 1, memory_order_seq_cst);
+
+        /* Recheck after announcing that we are going to sleep, otherwise we could miss the wake up */
+        bool found = ws_find(sched, thread_idx, task);
+        bool done  = !found && atomic_load_explicit(&sched->pending, memory_order_seq_cst) == 0;
+
+        if (!found && !done) futex_wait(&sched->signal, signal);
+
+        atomic_fetch_sub_explicit(&sched->sleepers, 1, memory_order_relaxed);
+
+        if (found) return true;
+        if (done) return false;
+    }
+}
+
+internal void ws_task_done(ws_scheduler_t *sched) {
+    /* The last task wakes everyone to return */
+    if (atomic_fetch_sub_explicit(&sched->pending, 1, memory_order_seq_cst) == 1) {
+        ws_wake(sched, INT_MAX);
+    }
+}
+
+internal void ws_split(ws_scheduler_t *sched, size_t thread_idx, ws_task_t *task, u64 grain) {
+
+    while (task->end - task->start + 1 > grain) {
+        u64 mid = task->start + (task->end - task->start) / 2;
+
+        ws_task_t upper = { .start = mid + 1, .end = task->end };
+        if (!ws_push(sched, thread_idx, upper)) break;
+
+        task->end = mid;
+    }
+}
+
+#endif /* ifndef WORK_STEALING_H */